@@ -0,0 +1,133 @@
+#include "main.h"
+#include "SupercellCompression.h"
+
+#include "io/buffer_stream.h"
+
+#include <string.h>
+
+using namespace sc::ScCompression;
+
+// Decompression is fast, so best time of several runs is taken to reduce noise
+static const uint32_t Decompress_Runs = 3;
+
+struct BenchResult
+{
+	double compress_time = 0.0;
+	double decompress_time = 0.0;
+	size_t compressed_length = 0;
+	bool valid = false;
+};
+
+static double seconds_since(time_point<high_resolution_clock> start)
+{
+	return duration<double>(high_resolution_clock::now() - start).count();
+}
+
+static BenchResult bench_sc(sc::Stream& input, Signature signature, uint32_t threads_count)
+{
+	BenchResult result;
+
+	Compressor::CompressorContext compressor_context;
+	compressor_context.signature = signature;
+	compressor_context.threads_count = threads_count;
+
+	input.seek(0);
+	sc::BufferStream compressed;
+	{
+		time_point start = high_resolution_clock::now();
+		Compressor::compress(input, compressed, compressor_context);
+		result.compress_time = seconds_since(start);
+	}
+	result.compressed_length = compressed.length();
+
+	Decompressor::DecompressorContext decompressor_context;
+	decompressor_context.threads_count = threads_count;
+
+	result.valid = true;
+	for (uint32_t run = 0; Decompress_Runs > run; run++)
+	{
+		compressed.seek(0);
+		sc::BufferStream decompressed;
+
+		time_point start = high_resolution_clock::now();
+		Decompressor::decompress(compressed, decompressed, decompressor_context);
+		double time = seconds_since(start);
+
+		if (run == 0 || result.decompress_time > time)
+		{
+			result.decompress_time = time;
+		}
+
+		// Every run must give data that is bit-identical to input
+		result.valid = result.valid && decompressed.length() == input.length() &&
+			(input.length() == 0 || memcmp(decompressed.data(), input.data(), input.length()) == 0);
+	}
+
+	return result;
+}
+
+static const char* decoder_name(Signature signature)
+{
+	if (signature != Signature::Lzma)
+	{
+		return "default";
+	}
+
+	return sc::lzma::has_optimized_decoder() ? "optimized x86-64 assembly" : "generic C";
+}
+
+static void print_bench(const char* name, size_t input_length, Signature signature, const BenchResult& result)
+{
+	double megabytes = (double)input_length / (1024 * 1024);
+
+	print(name << ": ratio " << (double)result.compressed_length / input_length
+		<< ", compress " << megabytes / result.compress_time << " MB/s"
+		<< ", decompress " << megabytes / result.decompress_time << " MB/s"
+		<< ", decoder " << decoder_name(signature)
+		<< (result.valid ? "" : ", [ERROR] decompressed data does not match input"));
+}
+
+bool binary_bench(sc::Stream& input, CommandLineOptions& options)
+{
+	Signature signature;
+	switch (options.binary.method)
+	{
+	case CompressionMethod::LZMA:
+		signature = Signature::Lzma;
+		break;
+	case CompressionMethod::ZSTD:
+		signature = Signature::Zstandard;
+		break;
+	case CompressionMethod::LZHAM:
+		signature = Signature::Lzham;
+		break;
+	default:
+		std::cout << "[ERROR] Unsupported method for benchmark. Supported only LZMA, ZSTD and LZHAM" << std::endl;
+		return false;
+	}
+
+	// Speed and ratio of empty input have no meaning
+	if (input.length() == 0)
+	{
+		std::cout << "[ERROR] Input file is empty" << std::endl;
+		return false;
+	}
+
+	print("Benchmarking SC compression of " << input.length() << " bytes...");
+
+	// Single thread result is a baseline for multithreaded one
+	BenchResult single_thread = bench_sc(input, signature, 1);
+	print_bench("1 thread", input.length(), signature, single_thread);
+
+	bool valid = single_thread.valid;
+	if (options.threads > 1)
+	{
+		BenchResult multi_thread = bench_sc(input, signature, options.threads);
+		print_bench((std::to_string(options.threads) + " threads").c_str(), input.length(), signature, multi_thread);
+		print("Compression speedup: " << single_thread.compress_time / multi_thread.compress_time << "x");
+
+		valid = valid && multi_thread.valid;
+	}
+
+	return valid;
+}
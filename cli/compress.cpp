@@ -17,6 +17,7 @@ void LZHAM_compress(sc::Stream& input, sc::Stream& output, CommandLineOptions& o
 		Compressor::CompressorContext context;
 		context.signature = Signature::Lzham;
 		context.threads_count = options.threads;
+		context.lzham_large_dictionary = options.binary.sc.lzham_large_dictionary;
 
 		Compressor::compress(input, output, context);
 	}
@@ -68,6 +69,25 @@ void LZMA_compress(sc::Stream& input, sc::Stream& output, CommandLineOptions& op
 	}
 }
 
+void LZMA2_compress(sc::Stream& input, sc::Stream& output, CommandLineOptions& options)
+{
+	switch (options.binary.container)
+	{
+	case FileContainer::None:
+	{
+		Lzma2::Props props;
+		props.threads_count = options.threads;
+
+		Lzma2 context(props);
+		context.compress_stream(input, output);
+	}
+	break;
+	default:
+		std::cout << "[ERROR] Unsupported container for LZMA2. Supported only None." << std::endl;
+		break;
+	}
+}
+
 void ZSTD_compress(sc::Stream& input, sc::Stream& output, CommandLineOptions& options)
 {
 	switch (options.binary.container)
@@ -76,9 +96,14 @@ void ZSTD_compress(sc::Stream& input, sc::Stream& output, CommandLineOptions& op
 	{
 		using namespace sc::ScCompression;
 
+		std::unique_ptr<sc::zstd::Dictionary> dictionary = load_zstd_dictionary(options);
+
 		Compressor::CompressorContext context;
 		context.signature = Signature::Zstandard;
 		context.threads_count = options.threads;
+		context.frame_size = options.binary.zstd.frame_size;
+		context.write_seek_table = options.binary.zstd.write_seek_table;
+		context.dictionary = dictionary.get();
 
 		Compressor::compress(input, output, context);
 	}
@@ -87,6 +112,16 @@ void ZSTD_compress(sc::Stream& input, sc::Stream& output, CommandLineOptions& op
 	case FileContainer::None:
 	{
 		Zstd::Props props;
+		if (options.binary.zstd.compression_level)
+		{
+			props.compression_level = options.binary.zstd.compression_level;
+		}
+
+		std::unique_ptr<sc::zstd::Dictionary> dictionary = load_zstd_dictionary(options, props.compression_level);
+
+		props.frame_size = options.binary.zstd.frame_size;
+		props.write_seek_table = options.binary.zstd.write_seek_table;
+		props.dictionary = dictionary.get();
 		// TODO: more params
 
 		sc::Compressor::Zstd context(props);
@@ -99,6 +134,36 @@ void ZSTD_compress(sc::Stream& input, sc::Stream& output, CommandLineOptions& op
 	};
 }
 
+void AUTO_compress(sc::Stream& input, sc::Stream& output, CommandLineOptions& options)
+{
+	switch (options.binary.container)
+	{
+	case FileContainer::SC:
+	{
+		using namespace sc::ScCompression;
+
+		// Dictionary is used by Zstandard samples and by output if Zstandard is selected
+		std::unique_ptr<sc::zstd::Dictionary> dictionary = load_zstd_dictionary(options);
+
+		Compressor::CompressorContext context;
+		context.signature = Signature::Auto;
+		context.auto_selection.min_decode_speed = options.binary.sc.min_decode_speed;
+		context.threads_count = options.threads;
+		context.lzham_large_dictionary = options.binary.sc.lzham_large_dictionary;
+		context.frame_size = options.binary.zstd.frame_size;
+		context.write_seek_table = options.binary.zstd.write_seek_table;
+		context.dictionary = dictionary.get();
+
+		Compressor::compress(input, output, context);
+	}
+	break;
+
+	default:
+		std::cout << "[ERROR] Unsupported container for AUTO. Supported only SC." << std::endl;
+		break;
+	};
+}
+
 bool binary_compressing(sc::Stream& input_stream, sc::Stream& output_stream, CommandLineOptions& options)
 {
 	switch (options.binary.method)
@@ -107,6 +172,10 @@ bool binary_compressing(sc::Stream& input_stream, sc::Stream& output_stream, Com
 		LZMA_compress(input_stream, output_stream, options);
 		break;
 
+	case CompressionMethod::LZMA2:
+		LZMA2_compress(input_stream, output_stream, options);
+		break;
+
 	case CompressionMethod::ZSTD:
 		ZSTD_compress(input_stream, output_stream, options);
 		break;
@@ -115,6 +184,10 @@ bool binary_compressing(sc::Stream& input_stream, sc::Stream& output_stream, Com
 		LZHAM_compress(input_stream, output_stream, options);
 		break;
 
+	case CompressionMethod::AUTO:
+		AUTO_compress(input_stream, output_stream, options);
+		break;
+
 	default:
 		std::cout << "[ERROR] Unknown compression method" << std::endl;
 		return false;
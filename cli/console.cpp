@@ -1,4 +1,5 @@
 #include "console.h"
+#include <cstring>
 
 void make_lowercase(std::string& data)
 {
@@ -16,16 +17,28 @@ void make_uppercase(std::string& data)
 		});
 }
 
+// Argument matches option only by its whole name, so option can not match another option that starts with its name
+static bool match_option(const std::string& arg, const char* option)
+{
+	std::size_t length = std::strlen(option);
+	if (0 != arg.compare(0, length, option)) return false;
+
+	return arg.size() == length || arg[length] == '=';
+}
+
 std::string get_option(int argc, char* argv[], const char* option)
 {
 	std::string cmd;
 	for (int i = 0; i < argc; ++i)
 	{
 		std::string arg = argv[i];
-		if (0 == arg.find(option))
+		if (match_option(arg, option))
 		{
 			std::size_t found = arg.find_first_of("=");
-			cmd = arg.substr(found + 1);
+			if (found != std::string::npos)
+			{
+				cmd = arg.substr(found + 1);
+			}
 			return cmd;
 		}
 	}
@@ -57,7 +70,7 @@ bool is_option_in(int argc, char* argv[], const char* option) {
 	for (int i = 0; i < argc; ++i)
 	{
 		std::string arg = argv[i];
-		if (0 == arg.find(option))
+		if (match_option(arg, option))
 		{
 			return true;
 		}
@@ -22,6 +22,17 @@ void LZMA_decompress(sc::Stream& input, sc::Stream& output, CommandLineOptions&
 	context.decompress_stream(input, output);
 }
 
+void LZMA2_decompress(sc::Stream& input, sc::Stream& output, CommandLineOptions& options)
+{
+	Lzma2::Props props;
+	props.dict_size_prop = input.read_unsigned_byte();
+	props.unpacked_length = input.read_unsigned_long();
+	props.threads_count = options.threads;
+
+	sc::Decompressor::Lzma2 context(props);
+	context.decompress_stream(input, output);
+}
+
 void LZHAM_decompress(sc::Stream& input, sc::Stream& output, CommandLineOptions&)
 {
 	uint32_t magic = input.read_int();
@@ -38,9 +49,15 @@ void LZHAM_decompress(sc::Stream& input, sc::Stream& output, CommandLineOptions&
 	context.decompress_stream(input, output);
 }
 
-void ZSTD_decompress(sc::Stream& input, sc::Stream& output, CommandLineOptions&)
+void ZSTD_decompress(sc::Stream& input, sc::Stream& output, CommandLineOptions& options)
 {
-	sc::Decompressor::Zstd context;
+	std::unique_ptr<sc::zstd::Dictionary> dictionary = load_zstd_dictionary(options);
+
+	Zstd::Props props;
+	props.threads_count = options.threads;
+	props.dictionary = dictionary.get();
+
+	sc::Decompressor::Zstd context(props);
 	context.decompress_stream(input, output);
 }
 
@@ -60,10 +77,17 @@ void SC_decompress(sc::Stream& input, sc::Stream& output, CommandLineOptions& op
 {
 	using namespace sc::ScCompression;
 
+	std::unique_ptr<sc::zstd::Dictionary> dictionary = load_zstd_dictionary(options);
+
+	Decompressor::DecompressorContext context;
+	context.verify_hash = options.binary.sc.verify_hash;
+	context.threads_count = options.threads;
+	context.dictionary = dictionary.get();
+
 	if (options.binary.sc.print_metadata)
 	{
 		MetadataAssetArray array;
-		Decompressor::decompress(input, output, &array);
+		Decompressor::decompress(input, output, context, &array);
 
 		if (array.size())
 		{
@@ -83,7 +107,7 @@ void SC_decompress(sc::Stream& input, sc::Stream& output, CommandLineOptions& op
 	}
 	else
 	{
-		Decompressor::decompress(input, output, nullptr);
+		Decompressor::decompress(input, output, context, nullptr);
 	}
 }
 
@@ -110,6 +134,10 @@ bool binary_decompressing(sc::Stream& input_stream, sc::Stream& output_stream, C
 			LZMA_decompress(input_stream, output_stream, options);
 			break;
 
+		case CompressionMethod::LZMA2:
+			LZMA2_decompress(input_stream, output_stream, options);
+			break;
+
 		case CompressionMethod::ZSTD:
 			ZSTD_decompress(input_stream, output_stream, options);
 			break;
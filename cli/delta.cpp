@@ -0,0 +1,49 @@
+#include "main.h"
+#include "SupercellCompression.h"
+
+bool zstd_diff(sc::Stream& input, sc::Stream& output, CommandLineOptions& options)
+{
+	if (options.binary.zstd.reference_path.empty() || !fs::exists(options.binary.zstd.reference_path))
+	{
+		std::cout << "[ERROR] Reference file does not exist" << std::endl;
+		return false;
+	}
+
+	sc::InputMappedFileStream reference(options.binary.zstd.reference_path);
+
+	sc::Compressor::Zstd::Props props;
+	props.compression_level = 19;
+	if (options.binary.zstd.compression_level)
+	{
+		props.compression_level = options.binary.zstd.compression_level;
+	}
+	props.workers_count = options.threads;
+	props.reference = (const uint8_t*)reference.data();
+	props.reference_length = reference.length();
+
+	sc::Compressor::Zstd context(props);
+	context.compress_stream(input, output);
+
+	return true;
+}
+
+bool zstd_patch(sc::Stream& input, sc::Stream& output, CommandLineOptions& options)
+{
+	if (options.binary.zstd.reference_path.empty() || !fs::exists(options.binary.zstd.reference_path))
+	{
+		std::cout << "[ERROR] Reference file does not exist" << std::endl;
+		return false;
+	}
+
+	sc::InputMappedFileStream reference(options.binary.zstd.reference_path);
+
+	sc::Decompressor::Zstd::Props props;
+	props.threads_count = options.threads;
+	props.reference = (const uint8_t*)reference.data();
+	props.reference_length = reference.length();
+
+	sc::Decompressor::Zstd context(props);
+	context.decompress_stream(input, output);
+
+	return true;
+}
@@ -0,0 +1,54 @@
+#include "main.h"
+#include "SupercellCompression.h"
+
+#include <vector>
+
+std::unique_ptr<sc::zstd::Dictionary> load_zstd_dictionary(CommandLineOptions& options, int compression_level)
+{
+	if (options.binary.zstd.dictionary_path.empty())
+	{
+		return nullptr;
+	}
+
+	sc::InputFileStream file(options.binary.zstd.dictionary_path);
+
+	std::vector<uint8_t> content(file.length());
+	file.read(content.data(), content.size());
+
+	return std::make_unique<sc::zstd::Dictionary>(content.data(), content.size(), compression_level);
+}
+
+bool zstd_train(CommandLineOptions& options)
+{
+	// Every file in input folder is a sample
+	std::vector<std::vector<uint8_t>> samples;
+	for (const fs::directory_entry& entry : fs::recursive_directory_iterator(options.input_path))
+	{
+		if (!entry.is_regular_file())
+		{
+			continue;
+		}
+
+		sc::InputFileStream file(entry.path());
+
+		std::vector<uint8_t>& sample = samples.emplace_back(file.length());
+		file.read(sample.data(), sample.size());
+	}
+
+	if (samples.empty())
+	{
+		std::cout << "[ERROR] Input folder does not have any samples" << std::endl;
+		return false;
+	}
+
+	print("Training dictionary on " << samples.size() << " samples...");
+
+	std::vector<uint8_t> dictionary = sc::zstd::train_dictionary(samples, options.binary.zstd.dictionary_size);
+
+	sc::OutputFileStream output(options.output_path);
+	output.write(dictionary.data(), dictionary.size());
+
+	print("Dictionary size: " << dictionary.size() << " bytes");
+
+	return true;
+}
@@ -0,0 +1,58 @@
+#include "main.h"
+#include "SupercellCompression.h"
+
+#include <iomanip>
+
+using namespace sc::ScCompression;
+
+const char* signature_name(Signature signature)
+{
+	switch (signature)
+	{
+	case Signature::Lzma:
+		return "LZMA";
+	case Signature::Lzham:
+		return "LZHAM";
+	case Signature::Zstandard:
+		return "ZSTD";
+	default:
+		return "Unknown";
+	}
+}
+
+bool sc_info(sc::Stream& input, CommandLineOptions&)
+{
+	Info info = inspect(input);
+
+	print("Version: " << info.version);
+	print("Codec: " << signature_name(info.signature));
+
+	std::cout << "Hash: ";
+	for (uint8_t& byte : info.hash)
+	{
+		std::cout << std::setfill('0') << std::setw(2) << std::hex << (unsigned int)byte;
+	}
+	std::cout << std::dec << std::endl;
+
+	print("Compressed data offset: " << info.data_offset << ", length: " << info.data_length);
+
+	if (info.unpacked_length != Info::UnknownLength)
+	{
+		print("Unpacked length: " << info.unpacked_length);
+	}
+	else
+	{
+		print("Unpacked length: Unknown");
+	}
+
+	if (info.has_metadata)
+	{
+		print("Metadata offset: " << info.metadata_offset << ", length: " << info.metadata_length);
+	}
+	else
+	{
+		print("Metadata: None");
+	}
+
+	return true;
+}
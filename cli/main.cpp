@@ -1,7 +1,8 @@
 #include "main.h"
 
-#include "io/buffer_stream.h"
 #include "io/file_stream.h"
+#include "SupercellCompression/ScCompression.h"
+#include "SupercellCompression/MappedFileStream.h"
 #include "exception/GeneralRuntimeException.h"
 #include "stb/stb.h"
 
@@ -15,6 +16,11 @@ void print_usage()
 	print("> d, decompress: Decompress binary file");
 	print("> c, compress: Compress binary file");
 	print("> v, convert: Converts a file from one file type to another of the same format");
+	print("> i, info: Prints SC file header info without decompressing it. Output file is not required");
+	print("> t, train: Trains ZSTD dictionary on every file from input folder and saves it to output file");
+	print("> b, bench: Compresses and decompresses file in SC container with one and with all threads, prints speed and checks result. Output file is not required");
+	print("> diff: Compresses new version of file as ZSTD patch against previous version from " OptionPrefix "reference option");
+	print("> patch: Restores new version of file from ZSTD patch and previous version from " OptionPrefix "reference option");
 	std::cout << std::endl;
 
 	print("> Additional options: ");
@@ -26,7 +32,9 @@ void print_usage()
 	std::cout << std::endl;
 
 	print("Binary Options:");
-	print("   " OptionPrefix"method: Sets compression method by which file will be compressed or decompressed. Possible values - LZMA, ZSTD, LZHAM, ASTC. Default - ZSTD");
+	print("   " OptionPrefix"method: Sets compression method by which file will be compressed or decompressed. Possible values - LZMA, LZMA2, ZSTD, LZHAM, ASTC, AUTO. Default - ZSTD");
+	print("   LZMA2 method splits file into independent blocks that are compressed and decompressed by all threads. Works only without container");
+	print("   AUTO method compresses samples of file with every codec and selects the best one. Works only with SC container");
 
 	std::cout << std::endl;
 
@@ -38,6 +46,19 @@ void print_usage()
 
 	print("SC:");
 	print("   " OptionPrefix"print_sc_metadata: If file has metadata, it will be displayed in the console. Boolean option.");
+	print("   " OptionPrefix"verify_sc_hash: Checks hash of decompressed data and fails if file is corrupted. Boolean option.");
+	print("   " OptionPrefix"autoMinDecodeSpeed: Minimal decompression speed in MB/s for AUTO method. The smallest output among codecs that are fast enough is selected.");
+	print("   " OptionPrefix"lzhamLargeDictionary: Lets LZHAM use dictionary bigger than 256 KB for large inputs. Decompression needs more memory. Boolean option.");
+
+	std::cout << std::endl;
+
+	print("ZSTD:");
+	print("   " OptionPrefix"zstdLevel: Compression level for ZSTD method without container and for diff operation. Default - 3, for diff - 19");
+	print("   " OptionPrefix"zstdFrameSize: Splits data into independent frames of specified size in bytes, so it can be decompressed in parallel.");
+	print("   " OptionPrefix"zstdSeekTable: Writes table with position of every frame. Works only with zstdFrameSize. Boolean option.");
+	print("   " OptionPrefix"zstdDictionary: Path to dictionary file for compression and decompression.");
+	print("   " OptionPrefix"zstdDictionarySize: Maximum size of trained dictionary in bytes. Default - 112640");
+	print("   " OptionPrefix"reference: Path to previous version of file for diff and patch operations.");
 
 	std::cout << std::endl;
 
@@ -72,20 +93,28 @@ void print_time(time_point<high_resolution_clock> start, time_point<high_resolut
 int main(int argc, char* argv[])
 {
 	printf("Ultimate SC Compression Tool - %s Command Line app - Compiled %s %s\n\n", PLATFORM, __DATE__, __TIME__);
-	if (argc < 4) {
+	if (argc < 3) {
 		print_usage();
 		return 0;
 	}
 
 	CommandLineOptions options(argc, argv);
 
+	// Operations that only read input file
+	bool output_required = options.operation != Operations::Info && options.operation != Operations::Bench;
+
+	if (output_required && argc < 4) {
+		print_usage();
+		return 0;
+	}
+
 	// -- Files --
 	if (options.input_path.empty() || !fs::exists(options.input_path)) {
 		std::cout << "[ERROR] Input file does not exist." << std::endl;
 		return 0;
 	}
 
-	if (options.output_path.empty()) {
+	if (output_required && options.output_path.empty()) {
 		std::cout << "[ERROR] Output file path is empty" << std::endl;
 		return 0;
 	}
@@ -102,53 +131,119 @@ int main(int argc, char* argv[])
 			operation_describe = "Compress";
 			print("Compressing...");
 
+			// Input is read in chunks and compressed data goes straight to file,
+			// so memory usage does not depend on file size
 			sc::InputFileStream input_stream(options.input_path);
-			sc::BufferStream output_stream;
+			sc::OutputFileStream output_stream(options.output_path);
 
 			if (!binary_compressing(input_stream, output_stream, options))
 			{
 				return 1;
 			}
-
-			// Writing memory to file
-			{
-				sc::OutputFileStream output_file(options.output_path);
-				output_file.write(output_stream.data(), output_stream.length());
-			}
 		}
 		else if (options.operation == Operations::Decompress)
 		{
 			operation_describe = "Decompress";
 
-			sc::BufferStream input_stream;
-			sc::OutputFileStream output_stream(options.output_path);
+			// File is mapped to memory instead of copying
+			sc::InputMappedFileStream input_stream(options.input_path);
 
-			// Loading file to memory
+			// SC header stores length of decompressed data, so output file can be created with final length
+			// and mapped to memory. Decompressor then writes data right to file pages.
+			// Length from header is trusted only as much as decompressors trust it for allocation
+			uint64_t unpacked_length = sc::ScCompression::Info::UnknownLength;
+			if (options.binary.container == FileContainer::SC)
 			{
-				sc::InputFileStream input_file(options.input_path);
-				input_stream.resize(input_file.length());
-				input_file.read(input_stream.data(), input_file.length());
+				sc::ScCompression::Info info = sc::ScCompression::inspect(input_stream);
+				if (info.unpacked_length <= SIZE_MAX &&
+					sc::Decompressor::DecompressionInterface::can_reserve(static_cast<size_t>(info.unpacked_length), info.data_length))
+				{
+					unpacked_length = info.unpacked_length;
+				}
 			}
 
 			print("Decompressing...");
 
-			if (!binary_decompressing(input_stream, output_stream, options))
+			bool result = false;
+			if (unpacked_length != sc::ScCompression::Info::UnknownLength)
+			{
+				sc::OutputMappedFileStream output_stream(options.output_path, static_cast<size_t>(unpacked_length));
+				result = binary_decompressing(input_stream, output_stream, options);
+			}
+			else
+			{
+				sc::OutputFileStream output_stream(options.output_path);
+				result = binary_decompressing(input_stream, output_stream, options);
+			}
+
+			if (!result)
 			{
 				return 1;
 			}
 		}
-		else if (options.operation == Operations::Convert)
+		else if (options.operation == Operations::Info)
 		{
-			operation_describe = "Convert";
+			operation_describe = "Info";
 
-			sc::BufferStream input_stream;
+			// Only header is read from file
+			sc::InputFileStream input_stream(options.input_path);
 
-			// Loading file to memory
+			if (!sc_info(input_stream, options))
 			{
-				sc::InputFileStream input_file(options.input_path);
-				input_stream.resize(input_file.length());
-				input_file.read(input_stream.data(), input_file.length());
+				return 1;
 			}
+		}
+		else if (options.operation == Operations::Bench)
+		{
+			operation_describe = "Bench";
+
+			sc::InputMappedFileStream input_stream(options.input_path);
+
+			if (!binary_bench(input_stream, options))
+			{
+				return 1;
+			}
+		}
+		else if (options.operation == Operations::Diff)
+		{
+			operation_describe = "Diff";
+			print("Compressing patch...");
+
+			sc::InputFileStream input_stream(options.input_path);
+			sc::OutputFileStream output_stream(options.output_path);
+
+			if (!zstd_diff(input_stream, output_stream, options))
+			{
+				return 1;
+			}
+		}
+		else if (options.operation == Operations::Patch)
+		{
+			operation_describe = "Patch";
+			print("Applying patch...");
+
+			sc::InputMappedFileStream input_stream(options.input_path);
+			sc::OutputFileStream output_stream(options.output_path);
+
+			if (!zstd_patch(input_stream, output_stream, options))
+			{
+				return 1;
+			}
+		}
+		else if (options.operation == Operations::Train)
+		{
+			operation_describe = "Train";
+
+			if (!zstd_train(options))
+			{
+				return 1;
+			}
+		}
+		else if (options.operation == Operations::Convert)
+		{
+			operation_describe = "Convert";
+
+			sc::InputMappedFileStream input_stream(options.input_path);
 
 			print("Converting...");
 
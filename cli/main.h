@@ -2,6 +2,9 @@
 #include "options.h"
 #include "io/stream.h"
 #include "io/file_stream.h"
+#include "SupercellCompression/Zstd.h"
+
+#include <memory>
 
 #include <chrono>
 using namespace std::chrono;
@@ -25,5 +28,13 @@ void print_time(time_point<high_resolution_clock> start, time_point<high_resolut
 bool binary_compressing(sc::Stream& input_stream, sc::Stream& output_stream, CommandLineOptions& options);
 bool binary_decompressing(sc::Stream& input_stream, sc::Stream& output_stream, CommandLineOptions& options);
 bool image_convert(sc::Stream& input_stream, CommandLineOptions& options);
+bool sc_info(sc::Stream& input_stream, CommandLineOptions& options);
+bool zstd_train(CommandLineOptions& options);
+bool binary_bench(sc::Stream& input_stream, CommandLineOptions& options);
+bool zstd_diff(sc::Stream& input_stream, sc::Stream& output_stream, CommandLineOptions& options);
+bool zstd_patch(sc::Stream& input_stream, sc::Stream& output_stream, CommandLineOptions& options);
+
+// Returns nullptr if dictionary is not specified in options. Compression dictionary is prepared for compression_level
+std::unique_ptr<sc::zstd::Dictionary> load_zstd_dictionary(CommandLineOptions& options, int compression_level = 3);
 
 int main(int argc, char* argv[]);
@@ -42,10 +42,39 @@ CommandLineOptions::CommandLineOptions(int argc, char* argv[])
 		{
 			operation = Operations::Convert;
 		}
+
+		if (operation_name == "i" || operation_name == "info")
+		{
+			operation = Operations::Info;
+		}
+
+		if (operation_name == "t" || operation_name == "train")
+		{
+			operation = Operations::Train;
+		}
+
+		if (operation_name == "diff")
+		{
+			operation = Operations::Diff;
+		}
+
+		if (operation_name == "patch")
+		{
+			operation = Operations::Patch;
+		}
+
+		if (operation_name == "b" || operation_name == "bench")
+		{
+			operation = Operations::Bench;
+		}
 	}
 
 	input_path = fs::path(argv[2]);
-	output_path = fs::path(argv[3]);
+	// Some operations do not need output file, so options can start right after input file
+	if (argc > 3 && std::string(argv[3]).rfind(OptionPrefix, 0) != 0)
+	{
+		output_path = fs::path(argv[3]);
+	}
 
 	if (is_option_in(argc, argv, OptionPrefix "threads"))
 	{
@@ -101,6 +130,14 @@ CommandLineOptions::CommandLineOptions(int argc, char* argv[])
 			{
 				binary.method = CompressionMethod::ASTC;
 			}
+			else if (method_name == "auto")
+			{
+				binary.method = CompressionMethod::AUTO;
+			}
+			else if (method_name == "lzma2")
+			{
+				binary.method = CompressionMethod::LZMA2;
+			}
 			else
 			{
 				std::cout << "[WARNING] An unknown type of compression is specified. Instead, default is used - LZMA" << std::endl;
@@ -117,6 +154,34 @@ CommandLineOptions::CommandLineOptions(int argc, char* argv[])
 
 #pragma region SC Props
 	binary.sc.print_metadata = is_option_in(argc, argv, OptionPrefix "print_sc_metadata");
+	binary.sc.verify_hash = is_option_in(argc, argv, OptionPrefix "verify_sc_hash");
+	binary.sc.lzham_large_dictionary = is_option_in(argc, argv, OptionPrefix "lzhamLargeDictionary");
+
+	if (is_option_in(argc, argv, OptionPrefix "autoMinDecodeSpeed"))
+	{
+		binary.sc.min_decode_speed = get_int_option(argc, argv, OptionPrefix "autoMinDecodeSpeed");
+	}
+#pragma endregion
+
+#pragma region ZSTD Props
+	if (is_option_in(argc, argv, OptionPrefix "zstdLevel"))
+	{
+		binary.zstd.compression_level = get_int_option(argc, argv, OptionPrefix "zstdLevel");
+	}
+
+	if (is_option_in(argc, argv, OptionPrefix "zstdFrameSize"))
+	{
+		binary.zstd.frame_size = static_cast<size_t>(get_int_option(argc, argv, OptionPrefix "zstdFrameSize"));
+	}
+	binary.zstd.write_seek_table = is_option_in(argc, argv, OptionPrefix "zstdSeekTable");
+
+	binary.zstd.dictionary_path = fs::path(get_option(argc, argv, OptionPrefix "zstdDictionary"));
+	binary.zstd.reference_path = fs::path(get_option(argc, argv, OptionPrefix "reference"));
+	if (is_option_in(argc, argv, OptionPrefix "zstdDictionarySize"))
+	{
+		binary.zstd.dictionary_size = static_cast<size_t>(get_int_option(argc, argv, OptionPrefix "zstdDictionarySize"));
+	}
+
 #pragma endregion
 
 #pragma region LZMA Props
@@ -12,7 +12,9 @@ enum class CompressionMethod
 	LZMA = 0,
 	ZSTD,
 	LZHAM,
-	ASTC
+	ASTC,
+	AUTO,
+	LZMA2
 };
 
 enum class FileContainer
@@ -34,7 +36,12 @@ enum class Operations
 
 	Compress,
 	Decompress,
-	Convert
+	Convert,
+	Info,
+	Train,
+	Diff,
+	Patch,
+	Bench
 };
 
 #pragma region Images / Textures
@@ -61,9 +68,31 @@ struct LzmaOptions
 	bool use_long_unpacked_length = false;
 };
 
+struct ZstdOptions
+{
+	// 0 means default level of operation
+	int compression_level = 0;
+
+	size_t frame_size = 0;
+	bool write_seek_table = false;
+
+	fs::path dictionary_path;
+	size_t dictionary_size = 112640;
+
+	// Previous version of file for diff and patch operations
+	fs::path reference_path;
+};
+
 struct SCOptions
 {
 	bool print_metadata = false;
+	bool verify_hash = false;
+
+	// Decompression speed floor in MB/s for auto method
+	unsigned int min_decode_speed = 0;
+
+	// Lets LZHAM use dictionary bigger than 2^18 for large inputs
+	bool lzham_large_dictionary = false;
 };
 
 struct ASTCOptions
@@ -79,6 +108,7 @@ struct BinaryOptions
 
 	SCOptions sc;
 	LzmaOptions lzma;
+	ZstdOptions zstd;
 	ASTCOptions astc;
 };
 #pragma endregion
@@ -5,10 +5,14 @@ set(CompressionCLI_Headers
 )
 
 set(CompressionCLI_Source
+    "cli/bench.cpp"
     "cli/compress.cpp"
     "cli/console.cpp"
     "cli/decompress.cpp"
+    "cli/delta.cpp"
+    "cli/dictionary.cpp"
     "cli/image_convert.cpp"
+    "cli/info.cpp"
     "cli/main.cpp"
     "cli/options.cpp"
 )
@@ -18,19 +18,104 @@ set(LZMA_LIB_Sources
     "${LZMA_LIB_SOURCE_DIR}/LzFind.c"
     "${LZMA_LIB_SOURCE_DIR}/LzmaDec.c"
     "${LZMA_LIB_SOURCE_DIR}/LzmaEnc.c"
+    "${LZMA_LIB_SOURCE_DIR}/Lzma2Dec.c"
+    "${LZMA_LIB_SOURCE_DIR}/Lzma2DecMt.c"
+    "${LZMA_LIB_SOURCE_DIR}/Lzma2Enc.c"
     "${LZMA_LIB_SOURCE_DIR}/7zFile.c"
     "${LZMA_LIB_SOURCE_DIR}/7zStream.c"
 )
 
+# Multithreaded match finder and LZMA2 block coders. Used by LZMA encoder when Props::threads is 2
+# and by LZMA2 encoder and decoder to process independent blocks in parallel.
+# Enabled by default only on Unix systems other than Apple, where SDK threads are built with pthreads
+if(UNIX AND NOT APPLE)
+    set(SC_LZMA_MULTITHREADED_DEFAULT ON)
+else()
+    set(SC_LZMA_MULTITHREADED_DEFAULT OFF)
+endif()
+
+option(SC_LZMA_MULTITHREADED "Build LZMA encoder with multithreaded match finder" ${SC_LZMA_MULTITHREADED_DEFAULT})
+
+if(${SC_LZMA_MULTITHREADED})
+    list(APPEND LZMA_LIB_Sources
+        "${LZMA_LIB_SOURCE_DIR}/LzFindMt.c"
+        "${LZMA_LIB_SOURCE_DIR}/MtCoder.c"
+        "${LZMA_LIB_SOURCE_DIR}/MtDec.c"
+        "${LZMA_LIB_SOURCE_DIR}/Threads.c"
+    )
+
+    # Optimized match search for match finder thread, exists only in newer SDK versions
+    if(EXISTS "${LZMA_LIB_SOURCE_DIR}/LzFindOpt.c")
+        list(APPEND LZMA_LIB_Sources "${LZMA_LIB_SOURCE_DIR}/LzFindOpt.c")
+    endif()
+endif()
+
+# Hand-optimized x86-64 decoder loop. Assembled by UASM or ASMC, generic C loop is used when it is not available
+option(SC_LZMA_ASM_DECODER "Build LZMA decoder with optimized x86-64 assembly loop" OFF)
+
+set(LZMA_ASM_DECODER_ENABLED FALSE)
+set(LZMA_ASM_DECODER_SOURCE "${lzma_sdk_SOURCE_DIR}/Asm/x86/LzmaDecOpt.asm")
+
+if(${SC_LZMA_ASM_DECODER})
+    if(NOT (CMAKE_SYSTEM_NAME STREQUAL "Linux" AND CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64|AMD64|amd64"))
+        message(WARNING "Optimized LZMA decoder is supported only on Linux x86-64, generic decoder is used")
+    elseif(NOT EXISTS "${LZMA_ASM_DECODER_SOURCE}")
+        message(WARNING "LZMA SDK has no LzmaDecOpt.asm, generic decoder is used")
+    else()
+        find_program(LZMA_ASSEMBLER NAMES uasm asmc)
+
+        if(NOT LZMA_ASSEMBLER)
+            message(WARNING "UASM or ASMC assembler is not found, generic LZMA decoder is used")
+        else()
+            set(LZMA_ASM_DECODER_OBJECT "${CMAKE_CURRENT_BINARY_DIR}/LzmaDecOpt.o")
+
+            # Assembled from its own directory, so included 7zAsm.asm is found
+            add_custom_command(
+                OUTPUT "${LZMA_ASM_DECODER_OBJECT}"
+                COMMAND ${LZMA_ASSEMBLER} -nologo -elf64 -DABI_LINUX "-Fo${LZMA_ASM_DECODER_OBJECT}" "${LZMA_ASM_DECODER_SOURCE}"
+                WORKING_DIRECTORY "${lzma_sdk_SOURCE_DIR}/Asm/x86"
+                DEPENDS "${LZMA_ASM_DECODER_SOURCE}"
+                COMMENT "Assembling optimized LZMA decoder"
+                VERBATIM
+            )
+
+            set_source_files_properties("${LZMA_ASM_DECODER_OBJECT}" PROPERTIES
+                EXTERNAL_OBJECT TRUE
+                GENERATED TRUE
+            )
+
+            list(APPEND LZMA_LIB_Sources "${LZMA_ASM_DECODER_OBJECT}")
+            set(LZMA_ASM_DECODER_ENABLED TRUE)
+        endif()
+    endif()
+endif()
+
 add_library("LzmaLib" STATIC ${LZMA_LIB_Sources})
 
 target_include_directories("LzmaLib" PRIVATE
     "${LZMA_LIB_SOURCE_DIR}"
 )
 
-target_compile_definitions("LzmaLib" PRIVATE
-    _7ZIP_ST
-)
+if(${SC_LZMA_MULTITHREADED})
+    set(THREADS_PREFER_PTHREAD_FLAG ON)
+    find_package(Threads REQUIRED)
+
+    target_link_libraries("LzmaLib" PUBLIC
+        Threads::Threads
+    )
+else()
+    # Public because layout of LZMA2 decoder props depends on it
+    target_compile_definitions("LzmaLib" PUBLIC
+        _7ZIP_ST
+    )
+endif()
+
+if(${LZMA_ASM_DECODER_ENABLED})
+    # Public so library can report which decoder is used
+    target_compile_definitions("LzmaLib" PUBLIC
+        _LZMA_DEC_OPT
+    )
+endif()
 
 target_compile_options("LzmaLib" PRIVATE
     $<$<AND:${SC_MSVC},${SC_RELEASE}>: /Ox /GF /Gy /GS- /Ob2 /Oi /Ot>
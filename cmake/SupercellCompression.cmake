@@ -13,15 +13,20 @@ set(Compression_Headers
     "include/SupercellCompression/exception/Astc.h"
     "include/SupercellCompression/exception/Lzham.h"
     "include/SupercellCompression/exception/Lzma.h"
+    "include/SupercellCompression/exception/MappedFileStream.h"
+    "include/SupercellCompression/exception/ScCompression.h"
     "include/SupercellCompression/exception/Zstd.h"
 
     "include/SupercellCompression/Astc.h"
     "include/SupercellCompression/KhronosTexture.h"
     "include/SupercellCompression/Lzham.h"
     "include/SupercellCompression/Lzma.h"
+    "include/SupercellCompression/Lzma2.h"
+    "include/SupercellCompression/MappedFileStream.h"
     "include/SupercellCompression/ScCompression.h"
     "include/SupercellCompression/Zstd.h"
 
+    "include/SupercellCompression/Astc/BatchCompressor.h"
     "include/SupercellCompression/Astc/Compressor.h"
     "include/SupercellCompression/Astc/Decompressor.h"
 
@@ -31,12 +36,22 @@ set(Compression_Headers
     "include/SupercellCompression/Lzma/Compressor.h"
     "include/SupercellCompression/Lzma/Decompressor.h"
 
+    "include/SupercellCompression/Lzma2/Compressor.h"
+    "include/SupercellCompression/Lzma2/Decompressor.h"
+
+    "include/SupercellCompression/Sc/MetadataView.h"
+    "include/SupercellCompression/Sc/Tuning.h"
+
     "include/SupercellCompression/Zstd/Compressor.h"
     "include/SupercellCompression/Zstd/Decompressor.h"
+    "include/SupercellCompression/Zstd/Dictionary.h"
 )
 
 set(Compression_Source
+    "source/Parallel.h"
+
     "source/Astc/Astc.cpp"
+    "source/Astc/BatchCompressor.cpp"
     "source/Astc/Compressor.cpp"
     "source/Astc/Decompressor.cpp"
 
@@ -46,12 +61,21 @@ set(Compression_Source
     "source/Lzma/Compressor.cpp"
     "source/Lzma/Decompressor.cpp"
 
+    "source/Lzma2/Compressor.cpp"
+    "source/Lzma2/Decompressor.cpp"
+
     "source/Sc/Compressor.cpp"
     "source/Sc/Decompressor.cpp"
+    "source/Sc/MetadataView.cpp"
+    "source/Sc/ScCompression.cpp"
+    "source/Sc/Tuning.cpp"
     "source/Zstd/Compressor.cpp"
     "source/Zstd/Decompressor.cpp"
+    "source/Zstd/Dictionary.cpp"
 
     "source/Image/KhronosTexture.cpp"
+
+    "source/IO/MappedFileStream.cpp"
 )
 
 add_library(${TARGET} STATIC ${Compression_Source} ${Compression_Headers})
@@ -76,7 +100,7 @@ message("-- ZStandart --")
 set(ZSTD_BUILD_STATIC ON)
 set(ZSTD_BUILD_SHARED OFF)
 set(ZSTD_LEGACY_SUPPORT OFF)
-set(ZSTD_BUILD_DICTBUILDER OFF)
+set(ZSTD_BUILD_DICTBUILDER ON)
 set(ZSTD_BUILD_DEPRECATED OFF)
 set(ZSTD_BUILD_PROGRAMS OFF)
 
@@ -0,0 +1,27 @@
+set(CompressionTests_Headers
+    "tests/test.h"
+)
+
+set(CompressionTests_Source
+    "tests/main.cpp"
+    "tests/astc.cpp"
+    "tests/lzham.cpp"
+    "tests/lzma.cpp"
+    "tests/mapped_file.cpp"
+    "tests/sc.cpp"
+    "tests/zstd.cpp"
+)
+
+add_executable("SupercellCompressionTests"
+    ${CompressionTests_Headers} ${CompressionTests_Source}
+)
+sc_core_base_setup("SupercellCompressionTests")
+set_target_properties("SupercellCompressionTests" PROPERTIES
+    FOLDER Supercell/Tests
+)
+
+target_link_libraries("SupercellCompressionTests" PUBLIC
+    SupercellCompression
+)
+
+add_test(NAME SupercellCompressionTests COMMAND "SupercellCompressionTests")
@@ -5,9 +5,13 @@
 
 // Binary Compression
 #include "SupercellCompression/Lzma.h"
+#include "SupercellCompression/Lzma2.h"
 #include "SupercellCompression/Zstd.h"
 #include "SupercellCompression/Lzham.h"
 
 // Compression headers
 #include "SupercellCompression/ScCompression.h"
 #include "SupercellCompression/KhronosTexture.h"
+
+// Streams
+#include "SupercellCompression/MappedFileStream.h"
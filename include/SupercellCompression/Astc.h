@@ -8,6 +8,7 @@
 struct astcenc_config;
 struct astcenc_swizzle;
 struct astcenc_context;
+struct astcenc_image;
 
 #pragma endregion
 
@@ -41,6 +42,9 @@ namespace sc
 
 		astcenc_swizzle get_swizzle(Image::BasePixelType type);
 
+		// Number of block rows in one band of striped compression and decompression
+		static const uint32_t DEFAULT_BAND_BLOCK_ROWS = 16;
+
 		const uint8_t FileIdentifier[4] = {
 			0x13, 0xAB, 0xA1, 0x5C
 		};
@@ -48,4 +52,5 @@ namespace sc
 }
 
 #include "SupercellCompression/Astc/Compressor.h"
-#include "SupercellCompression/Astc/Decompressor.h"
\ No newline at end of file
+#include "SupercellCompression/Astc/Decompressor.h"
+#include "SupercellCompression/Astc/BatchCompressor.h"
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+#include "SupercellCompression/Astc.h"
+#include "io/stream.h"
+
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace sc
+{
+	class ThreadPool;
+
+	namespace Compressor
+	{
+		class AstcBatch
+		{
+		public:
+			struct Props
+			{
+				astc::Profile profile = astc::Profile::PRF_LDR;
+				astc::Quality quality = astc::Quality::Medium;
+				uint32_t threads_count = std::thread::hardware_concurrency() == 0 ? 1 : std::thread::hardware_concurrency();
+
+				/* Number of block rows in one job */
+				/*
+					Rows of all images are split into jobs that threads take from one queue,
+					so many small images and one big image keep all threads busy the same way.
+					0 means about 4096 blocks per job.
+				*/
+				uint32_t job_block_rows = 0;
+			};
+
+			struct Entry
+			{
+				uint16_t width = 0;
+				uint16_t height = 0;
+
+				/* Selects channels that are encoded. Pixels are always read as 4 bytes like in Astc::compress_image */
+				Image::BasePixelType type = Image::BasePixelType::RGBA;
+
+				/* Image pixels. Must stay valid until compress returns */
+				const uint8_t* data = nullptr;
+
+				uint8_t blocks_x = 4;
+				uint8_t blocks_y = 4;
+
+				/* Receives compressed blocks of image without header */
+				Stream* output = nullptr;
+			};
+
+		public:
+			AstcBatch(Props& props);
+			~AstcBatch();
+
+			/// <summary>
+			/// Compresses all images at once. Images can have different block sizes,
+			/// compressed data is written to outputs in order of entries when all images are done.
+			/// </summary>
+			/// <param name="entries"></param>
+			void compress(std::vector<Entry>& entries);
+
+		private:
+			struct Job
+			{
+				size_t entry_index;
+				uint32_t first_row;
+				uint32_t rows_count;
+			};
+
+			// Gets context of thread for block size, allocates it on first use
+			int get_context(uint8_t blocks_x, uint8_t blocks_y, uint32_t thread_index, astcenc_context*& context);
+
+			static uint16_t context_key(uint8_t blocks_x, uint8_t blocks_y)
+			{
+				return (uint16_t)((blocks_x << 8) | blocks_y);
+			}
+
+		private:
+			astc::Profile m_profile;
+			astc::Quality m_quality;
+			uint32_t m_threads_count;
+			uint32_t m_job_block_rows;
+
+			// Threads are started once and reused by every batch
+			ThreadPool* m_pool;
+
+			// Single threaded context of every thread for every block size. Kept between batches
+			std::map<uint16_t, std::vector<astcenc_context*>> m_contexts;
+		};
+	}
+}
@@ -2,14 +2,21 @@
 #include "SupercellCompression/Astc.h"
 #include "SupercellCompression/interface/ImageCompressionInterface.h"
 
+#include <functional>
 #include <thread>
 
 namespace sc
 {
+	class ThreadPool;
+
 	namespace Compressor
 	{
 		class Astc : public ImageCompressionInterface
 		{
+		public:
+			// Fills memory with rows_count rows of image starting from first_row, 4 bytes per pixel
+			typedef std::function<void(uint32_t first_row, uint32_t rows_count, uint8_t* rows)> RowProducer;
+
 		public:
 			struct Props
 			{
@@ -41,9 +48,44 @@ namespace sc
 			/// <param name="output"></param>
 			void compress_image(uint16_t width, uint16_t height, Image::BasePixelType type, Stream& input, Stream& output) override;
 
+			/// <summary>
+			/// Compresses image by bands of block rows. Only one band of pixels and blocks is kept in memory,
+			/// blocks of every band are written to output right after it is compressed.
+			/// </summary>
+			/// <param name="width"></param>
+			/// <param name="height"></param>
+			/// <param name="type"></param>
+			/// <param name="producer">Provides rows of every band in order from top to bottom</param>
+			/// <param name="output"></param>
+			/// <param name="band_block_rows">Number of block rows in one band</param>
+			void compress_image_striped(
+				uint16_t width, uint16_t height, Image::BasePixelType type,
+				const RowProducer& producer, Stream& output,
+				uint32_t band_block_rows = astc::DEFAULT_BAND_BLOCK_ROWS
+			);
+
+			/// <summary>
+			/// Compresses image by bands of block rows, rows of pixels are read from input stream.
+			/// </summary>
+			void compress_image_striped(
+				uint16_t width, uint16_t height, Image::BasePixelType type,
+				Stream& input, Stream& output,
+				uint32_t band_block_rows = astc::DEFAULT_BAND_BLOCK_ROWS
+			);
+
+		private:
+			// Compresses image on all threads and resets context. Returns first error of threads
+			int compress_blocks(astcenc_image& image, astcenc_swizzle& swizzle, uint8_t* data, size_t data_size);
+
 		private:
 			astcenc_context* m_context;
+
+			// Every image is processed by this number of threads, each with its own thread index in context
+			uint32_t m_threads_count;
 			astcenc_config* m_config;
+
+			// Threads are started once and reused by every image and band
+			ThreadPool* m_pool;
 		};
 	}
 }
\ No newline at end of file
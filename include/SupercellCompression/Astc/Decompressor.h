@@ -3,12 +3,20 @@
 #include "SupercellCompression/interface/ImageDecompressionInterface.h"
 #include "generic/image/raw_image.h"
 
+#include <functional>
+
 namespace sc
 {
+	class ThreadPool;
+
 	namespace Decompressor
 	{
 		class Astc : public ImageDecompressionInterface
 		{
+		public:
+			// Receives rows_count decoded rows of image starting from first_row, 4 bytes per pixel
+			typedef std::function<void(uint32_t first_row, uint32_t rows_count, const uint8_t* rows)> RowConsumer;
+
 		public:
 			struct Props
 			{
@@ -25,6 +33,16 @@ namespace sc
 			/// </summary>
 			static void read_header(Stream& buffer, uint16_t& width, uint16_t& height, uint8_t& blocks_x, uint8_t& blocks_y);
 
+			/// <summary>
+			/// Reads ASTC file and decompresses its preview with one RGBA pixel per block, same as decompress_thumbnail
+			/// </summary>
+			/// <param name="input">ASTC file with header</param>
+			/// <param name="output"></param>
+			/// <param name="width">Preview width</param>
+			/// <param name="height">Preview height</param>
+			/// <param name="props">Block size is taken from file header</param>
+			static void read_thumbnail(Stream& input, Stream& output, uint16_t& width, uint16_t& height, Props props);
+
 		public:
 			Astc(Props& props);
 
@@ -33,8 +51,78 @@ namespace sc
 		public:
 			void decompress_image(uint16_t width, uint16_t height, Image::BasePixelType type, Stream& input, Stream& output);
 
+			/// <summary>
+			/// Decompresses only rectangle of image. Only blocks that cover rectangle are decoded.
+			/// Pixels are written as 4 bytes each, same as in decompress_image.
+			/// </summary>
+			/// <param name="width">Width of whole image</param>
+			/// <param name="height">Height of whole image</param>
+			/// <param name="type"></param>
+			/// <param name="input">Blocks of whole image</param>
+			/// <param name="x">Left side of rectangle</param>
+			/// <param name="y">Top side of rectangle</param>
+			/// <param name="region_width"></param>
+			/// <param name="region_height"></param>
+			/// <param name="destination">Memory for at least region_height rows of pixels</param>
+			/// <param name="destination_stride">Distance between rows of destination in bytes. 0 means tightly packed rows</param>
+			void decompress_region(
+				uint16_t width, uint16_t height, Image::BasePixelType type, Stream& input,
+				uint16_t x, uint16_t y, uint16_t region_width, uint16_t region_height,
+				uint8_t* destination, size_t destination_stride = 0
+			);
+
+			/// <summary>
+			/// Decompresses preview of image with one RGBA pixel per block. Pixel is average color of block
+			/// that is computed from block endpoints and mean of its weight grid without decoding of texels,
+			/// so color of blocks with several partitions is approximate.
+			/// Output has (width + blocks_x - 1) / blocks_x columns and (height + blocks_y - 1) / blocks_y rows.
+			/// </summary>
+			/// <param name="width">Width of whole image</param>
+			/// <param name="height">Height of whole image</param>
+			/// <param name="input">Blocks of whole image</param>
+			/// <param name="output"></param>
+			void decompress_thumbnail(uint16_t width, uint16_t height, Stream& input, Stream& output);
+
+			/// <summary>
+			/// Decompresses image by bands of block rows. Only one band of blocks and pixels is kept in memory,
+			/// blocks are read from input band by band, so input does not have to be in memory.
+			/// </summary>
+			/// <param name="width"></param>
+			/// <param name="height"></param>
+			/// <param name="type"></param>
+			/// <param name="input"></param>
+			/// <param name="consumer">Receives rows of every band in order from top to bottom</param>
+			/// <param name="band_block_rows">Number of block rows in one band</param>
+			void decompress_image_striped(
+				uint16_t width, uint16_t height, Image::BasePixelType type,
+				Stream& input, const RowConsumer& consumer,
+				uint32_t band_block_rows = astc::DEFAULT_BAND_BLOCK_ROWS
+			);
+
+			/// <summary>
+			/// Decompresses image by bands of block rows, rows of pixels are written to output stream.
+			/// </summary>
+			void decompress_image_striped(
+				uint16_t width, uint16_t height, Image::BasePixelType type,
+				Stream& input, Stream& output,
+				uint32_t band_block_rows = astc::DEFAULT_BAND_BLOCK_ROWS
+			);
+
+		private:
+			// Decompresses blocks on threads_count threads and resets context. Returns first error of threads
+			int decompress_blocks(const uint8_t* data, size_t data_size, astcenc_image& image, astcenc_swizzle& swizzle, uint32_t threads_count);
+
 		private:
 			astcenc_context* m_context;
+
+			uint8_t m_blocks_x;
+			uint8_t m_blocks_y;
+
+			// Every image is processed by this number of threads, each with its own thread index in context
+			uint32_t m_threads_count;
+
+			// Threads are started once and reused by every image and band
+			ThreadPool* m_pool;
 		};
 	}
 }
@@ -134,6 +134,15 @@ namespace sc
 		void decompress_data(Stream& output) override;
 		void decompress_data(Stream& output, uint32_t level_index);
 
+		/// <summary>
+		/// Decompresses preview of ASTC level with one RGBA pixel per block. Other textures have no preview and output size is 0
+		/// </summary>
+		/// <param name="output"></param>
+		/// <param name="width">Preview width</param>
+		/// <param name="height">Preview height</param>
+		/// <param name="level_index"></param>
+		void decompress_thumbnail(Stream& output, uint16_t& width, uint16_t& height, uint32_t level_index = 0);
+
 		void set_level_data(Stream& data, Image::PixelDepth data_format, uint32_t level_index);
 
 		void reset_level_data(uint32_t level_index);
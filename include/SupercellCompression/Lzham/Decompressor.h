@@ -30,6 +30,7 @@ namespace sc
 				// def=0, 32 or higher, scaled by 32, controls the slowing of the update update freq, higher=more rapid slowing (faster decode/lower ratio). Was 40 in prev. releases.
 				uint32_t table_update_interval_slow_rate = 64;
 
+				// SIZE_MAX if length is unknown. Data is then streamed until the end of LZHAM stream
 				size_t unpacked_length;
 			};
 		public:
@@ -38,9 +39,26 @@ namespace sc
 
 			void decompress_stream(Stream& input, Stream& output) override;
 
+			/// <summary>
+			/// Stops decompression as soon as length bytes are written to output, rest of stream is not decoded.
+			/// Lets caller take only beginning of data. SIZE_MAX means no limit
+			/// </summary>
+			void set_output_limit(size_t length)
+			{
+				m_output_limit = length;
+			}
+
 		private:
+			// Decompresses data with known unpacked length right into output memory by single unbuffered call
+			void decompress_direct(Stream& input, Stream& output, uint8_t* destination);
+
+		private:
+			Props m_props;
+
+			// Streaming state is created only when output memory can not be used directly
 			lzham_decompress_state_ptr m_state = nullptr;
 			size_t m_unpacked_length;
+			size_t m_output_limit = SIZE_MAX;
 
 			// -- Stream Buffer --
 			uint8_t* m_input_buffer = nullptr;
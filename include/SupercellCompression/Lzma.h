@@ -22,6 +22,9 @@ namespace sc
 		void* lzma_alloc(void*, size_t size);
 		void lzma_free(void*, void* address);
 
+		// Returns true if library is built with optimized assembly decoder
+		bool has_optimized_decoder();
+
 #pragma region Enums
 
 		enum class Mode : int
@@ -3,6 +3,7 @@
 
 #include "SupercellCompression/Lzma.h"
 #include "SupercellCompression/interface/CompressionInterface.h"
+#include "io/buffer_stream.h"
 
 namespace sc
 {
@@ -69,6 +70,11 @@ namespace sc
 				unsigned write_end_mark = false;
 
 				/* 1 or 2 */
+				/*
+					With 2 threads match finder works in a separate thread.
+					Requires library to be built with SC_LZMA_MULTITHREADED, which is on by default
+					only on Unix systems other than Apple. Otherwise 2 works as 1.
+				*/
 				int threads = std::thread::hardware_concurrency() >= 2 ? 2 : 1;
 
 				/* Estimated size of data that will be compressed */
@@ -77,6 +83,7 @@ namespace sc
 				*/
 				uint64_t reduce_size = UINT64_MAX;
 
+				/* CPU affinity mask for match finder thread. 0 means no affinity */
 				uint64_t affinity = 0;
 
 				/* If positive, writes the file length to a 64-bit integer, otherwise to a 32-bit integer */
@@ -87,11 +94,28 @@ namespace sc
 			Lzma(Props& props);
 			~Lzma();
 
+			/// <summary>
+			/// Compresses input to output. Same instance can compress any number of streams,
+			/// match finder memory is allocated once and reused while dictionary size stays the same.
+			/// </summary>
+			/// <param name="input"></param>
+			/// <param name="output"></param>
 			void compress_stream(Stream& input, Stream& output) override;
 
+			/// <summary>
+			/// Changes props of encoder for next streams without recreating it.
+			/// </summary>
+			/// <param name="props"></param>
+			void reset(Props& props);
+
+		private:
+			// Compresses data from memory with single call right into output buffer
+			void compress_memory(Stream& input, BufferStream& output, size_t length);
+
 		private:
 			CLzmaEncHandle m_context;
 			bool m_use_long_unpacked_data;
+			bool m_write_end_mark;
 		};
 	}
 }
\ No newline at end of file
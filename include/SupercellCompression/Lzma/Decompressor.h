@@ -17,12 +17,36 @@ namespace sc
 
 			void decompress_stream(Stream& input, Stream& output) override;
 
+			/// <summary>
+			/// Stops decompression as soon as length bytes are written to output, rest of stream is not decoded.
+			/// Lets caller take only beginning of data. SIZE_MAX means no limit
+			/// </summary>
+			void set_output_limit(size_t length)
+			{
+				m_output_limit = length;
+			}
+
+		private:
+			// Decompresses data with known unpacked size using destination memory as decoder dictionary
+			void decompress_direct(Stream& input, uint8_t* destination);
+
+			// Decompresses data through ring dictionary of decoder
+			void decompress_dictionary(Stream& input, Stream& output);
+
+			// Returns next chunk of compressed data. Data in memory is used directly, otherwise it is read to staging buffer
+			const uint8_t* next_input(Stream& input, size_t& length);
+
 		private:
 			LzmaDecompressContext* m_context;
+			uint8_t m_header[lzma::PROPS_SIZE];
 			size_t m_unpacked_size;
+			size_t m_output_limit = SIZE_MAX;
+
+			// Dictionary is allocated by decoder only for data that can not be decompressed into destination memory
+			bool m_owns_dictionary = false;
 
 			uint8_t* m_input_buffer = nullptr;
-			uint8_t* m_output_buffer = nullptr;
+			size_t m_input_buffer_size = 0;
 
 			// -- Compression Buffer --
 			static const size_t Stream_Size = 1 << 24;
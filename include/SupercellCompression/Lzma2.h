@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "SupercellCompression/Lzma.h"
+
+#pragma region Forward Declaration
+typedef void* CLzma2EncHandle;
+typedef void* CLzma2DecMtHandle;
+
+#pragma endregion
+
+namespace sc
+{
+	namespace lzma2
+	{
+#pragma region Constants
+
+		// Dictionary size property byte + 64-bit unpacked length
+		static const size_t HEADER_SIZE = 9;
+
+		// Written as unpacked length when it is not known
+		static const uint64_t UNKNOWN_LENGTH = UINT64_MAX;
+
+#pragma endregion
+	}
+}
+
+#include "Lzma2/Decompressor.h"
+#include "Lzma2/Compressor.h"
@@ -0,0 +1,53 @@
+#pragma once
+#include <thread>
+
+#include "SupercellCompression/Lzma2.h"
+#include "SupercellCompression/interface/CompressionInterface.h"
+
+namespace sc
+{
+	namespace Compressor
+	{
+		class Lzma2 : public CompressionInterface
+		{
+		public:
+			struct Props
+			{
+				/* Compression Level: [0 - 9] */
+				int level = 6;
+
+				/* Dictionary size. 0 means size selected by compression level */
+				uint32_t dict_size = 0;
+
+				/* Number of literal context bits: [0 - 8] */
+				int lc = 3;
+
+				/* Number of literal pos bits: [0 - 4] */
+				int lp = 0;
+
+				/* Number of pos bits: [0 - 4]*/
+				int pb = 2;
+
+				/* Size of independently compressed block */
+				/*
+					Every block starts with reset of dictionary, so blocks are compressed and decompressed in parallel.
+					Smaller blocks give more parallelism but a bit worse compression ratio.
+					0 means size selected from dictionary size (4x dictionary, at least 1MB).
+				*/
+				uint64_t block_size = 0;
+
+				/* Total number of threads for all blocks and their match finders */
+				uint32_t threads_count = std::thread::hardware_concurrency() == 0 ? 1 : std::thread::hardware_concurrency();
+			};
+
+		public:
+			Lzma2(Props& props);
+			~Lzma2();
+
+			void compress_stream(Stream& input, Stream& output) override;
+
+		private:
+			CLzma2EncHandle m_context;
+		};
+	}
+}
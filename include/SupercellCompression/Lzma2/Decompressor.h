@@ -0,0 +1,40 @@
+#pragma once
+#include <thread>
+
+#include "SupercellCompression/Lzma2.h"
+#include "SupercellCompression/interface/DecompressionInterface.h"
+
+namespace sc
+{
+	namespace Decompressor
+	{
+		class Lzma2 : public DecompressionInterface
+		{
+		public:
+			struct Props
+			{
+				/* Dictionary size property byte from header */
+				uint8_t dict_size_prop = 0;
+
+				/* Length of decompressed data or lzma2::UNKNOWN_LENGTH */
+				uint64_t unpacked_length = lzma2::UNKNOWN_LENGTH;
+
+				/* Independent blocks are decompressed in parallel by this number of threads */
+				uint32_t threads_count = std::thread::hardware_concurrency() == 0 ? 1 : std::thread::hardware_concurrency();
+			};
+
+		public:
+			Lzma2(Props& props);
+			~Lzma2();
+
+			void decompress_stream(Stream& input, Stream& output) override;
+
+		private:
+			CLzma2DecMtHandle m_context;
+
+			uint8_t m_dict_size_prop;
+			uint64_t m_unpacked_length;
+			uint32_t m_threads_count;
+		};
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "io/memory_stream.h"
+
+#include <stdint.h>
+#include <filesystem>
+
+namespace sc
+{
+	// Owns file mapping. Used as first base class of mapped streams, so memory is mapped before stream is constructed
+	class MappedFile
+	{
+	public:
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+	protected:
+		/// <summary>
+		/// Maps whole file to memory
+		/// </summary>
+		/// <param name="path">Path to file</param>
+		/// <param name="length">If file is writable, file is created or truncated to this length before mapping</param>
+		/// <param name="writable">Maps file for writing. Changes are written to file. Read-only mapping is marked for sequential access</param>
+		MappedFile(const std::filesystem::path& path, size_t length, bool writable);
+		~MappedFile();
+
+		// Writable file is truncated to this length when mapping is closed. SIZE_MAX keeps mapped length
+		void set_final_length(size_t length)
+		{
+			m_final_length = length;
+		}
+
+	protected:
+		uint8_t* m_mapped_data = nullptr;
+		size_t m_mapped_length = 0;
+		size_t m_final_length = SIZE_MAX;
+
+	private:
+#if defined _WIN32
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#else
+		int m_file = -1;
+#endif
+	};
+
+	/// <summary>
+	/// Read-only file mapped to memory. Provides data() like a buffer stream, but file is not copied to memory
+	/// and its pages are loaded by system on first access. Stream must not be written.
+	/// </summary>
+	class InputMappedFileStream : private MappedFile, public MemoryStream
+	{
+	public:
+		InputMappedFileStream(const std::filesystem::path& path)
+			: MappedFile(path, 0, false), MemoryStream(m_mapped_data, m_mapped_length)
+		{
+		}
+	};
+
+	/// <summary>
+	/// Writable file that is created with expected length and mapped to memory.
+	/// Decompressors write data right into the mapping without intermediate buffers.
+	/// When stream is destroyed, file is truncated to stream position, so data that ended early does not leave zero padding.
+	/// </summary>
+	class OutputMappedFileStream : private MappedFile, public MemoryStream
+	{
+	public:
+		OutputMappedFileStream(const std::filesystem::path& path, size_t length)
+			: MappedFile(path, length, true), MemoryStream(m_mapped_data, m_mapped_length)
+		{
+		}
+
+		~OutputMappedFileStream()
+		{
+			set_final_length(position());
+		}
+	};
+}
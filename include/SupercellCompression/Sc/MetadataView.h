@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+#include <string_view>
+#include <unordered_map>
+
+#include "io/stream.h"
+
+namespace sc
+{
+	namespace ScCompression
+	{
+		/// <summary>
+		/// Read-only view of SC metadata chunk. Offset tables are decoded in place, nothing is copied,
+		/// so view must not outlive memory it was created from (file buffer or mapped file).
+		/// </summary>
+		class MetadataView
+		{
+		public:
+			struct Asset
+			{
+				std::string_view name;
+
+				const uint8_t* hash = nullptr;
+				size_t hash_length = 0;
+			};
+
+			class Iterator
+			{
+			public:
+				Iterator(const MetadataView& view, uint32_t index) : m_view(view), m_index(index) {};
+
+				Asset operator*() const { return m_view.at(m_index); }
+				Iterator& operator++() { m_index++; return *this; }
+				bool operator!=(const Iterator& other) const { return m_index != other.m_index; }
+
+			private:
+				const MetadataView& m_view;
+				uint32_t m_index;
+			};
+
+		public:
+			/// <summary>
+			/// Creates view from end of SC file with metadata chunk
+			/// </summary>
+			/// <param name="buffer_end">Pointer to the end of whole SC file in memory</param>
+			/// <param name="build_index">Builds name index for find()</param>
+			MetadataView(const uint8_t* buffer_end, bool build_index = true);
+
+			/// <summary>
+			/// Creates view from stream with whole SC file. Stream must provide its data in memory.
+			/// </summary>
+			MetadataView(Stream& input, bool build_index = true);
+
+		public:
+			uint32_t size() const
+			{
+				return m_asset_count;
+			}
+
+			Asset at(uint32_t index) const;
+
+			Iterator begin() const { return Iterator(*this, 0); }
+			Iterator end() const { return Iterator(*this, m_asset_count); }
+
+			/// <summary>
+			/// Looks up asset by name in prebuilt index
+			/// </summary>
+			/// <returns>False if asset with this name does not exist or index was not built</returns>
+			bool find(std::string_view name, Asset& asset) const;
+
+		private:
+			void read(const uint8_t* buffer_end);
+
+		private:
+			const uint8_t* m_asset_info_ptr = nullptr;
+			const uint8_t* m_strings_ptr = nullptr;
+			const uint8_t* m_hash_flags_ptr = nullptr;
+
+			uint8_t m_info_field_size = 0;
+			uint8_t m_hash_info_field_size = 0;
+			uint32_t m_strings_info_field_size = 0;
+
+			uint32_t m_asset_count = 0;
+			uint32_t m_strings_count = 0;
+			uint32_t m_hash_count = 0;
+
+			std::unordered_map<std::string_view, uint32_t> m_index;
+		};
+	}
+}
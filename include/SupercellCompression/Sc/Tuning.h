@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "SupercellCompression/Zstd.h"
+#include "SupercellCompression/Lzham.h"
+#include "SupercellCompression/Lzma.h"
+
+namespace sc
+{
+	namespace ScCompression
+	{
+		namespace Compressor
+		{
+			/// <summary>
+			/// Sets dictionary size, compression level and threads count of LZMA props by input length.
+			/// Small inputs get small dictionary and no match finder thread, large inputs get bigger dictionary.
+			/// </summary>
+			/// <param name="props">Props to tune. Fields that do not depend on input are not changed</param>
+			/// <param name="input_length">Length of data that will be compressed</param>
+			/// <param name="threads_count">Available threads count</param>
+			void tune_props(sc::Compressor::Lzma::Props& props, size_t input_length, uint32_t threads_count);
+
+			/// <summary>
+			/// Sets dictionary size and helper threads count of LZHAM props by input length
+			/// </summary>
+			void tune_props(sc::Compressor::Lzham::Props& props, size_t input_length, uint32_t threads_count);
+
+			/// <summary>
+			/// Sets compression level, window size, job size and workers count of Zstandard props by input length
+			/// </summary>
+			void tune_props(sc::Compressor::Zstd::Props& props, size_t input_length, uint32_t threads_count);
+		}
+	}
+}
@@ -10,17 +10,25 @@
 #include "SupercellCompression/Lzham.h"
 #include "SupercellCompression/Lzma.h"
 
+#include "SupercellCompression/Sc/MetadataView.h"
+
 namespace sc {
 	namespace ScCompression
 	{
 		const uint16_t SC_MAGIC = 0x4353;
 		const uint32_t SCLZ_MAGIC = 0x5A4C4353;
 
+		// LZHAM dictionary size that SC files had before it was tuned by input length
+		const uint32_t SCLZ_DEFAULT_DICT_SIZE_LOG2 = 18;
+
 		enum class Signature
 		{
 			Lzma,
 			Lzham,
-			Zstandard
+			Zstandard,
+
+			// Compression only. Codec is selected by compressing samples of input with every codec
+			Auto
 		};
 
 		struct MetadataAsset
@@ -31,24 +39,109 @@ namespace sc {
 
 		typedef std::vector<MetadataAsset> MetadataAssetArray;
 
+		// Everything that can be known about SC file without decompressing it
+		struct Info
+		{
+			static const uint64_t UnknownLength = UINT64_MAX;
+
+			uint32_t version = 0;
+			Signature signature = Signature::Zstandard;
+
+			std::vector<uint8_t> hash;
+
+			// Compressed data position and length in file
+			size_t data_offset = 0;
+			size_t data_length = 0;
+
+			// Length of data after decompression. UnknownLength if codec header does not store it
+			uint64_t unpacked_length = UnknownLength;
+
+			// Metadata chunk position and length in file. Available only for files with version 4 header
+			bool has_metadata = false;
+			size_t metadata_offset = 0;
+			size_t metadata_length = 0;
+		};
+
+		/// <summary>
+		/// Reads SC header and codec header without decompressing anything. Stream position is restored after reading.
+		/// </summary>
+		/// <param name="input"></param>
+		/// <returns></returns>
+		Info inspect(Stream& input);
+
 		namespace Decompressor
 		{
+			struct DecompressorContext
+			{
+				// Calculates MD5 of decompressed data while it is written to output and compares it with hash from header
+				bool verify_hash = false;
+
+				// Zstandard data with several frames is decompressed in parallel
+				uint32_t threads_count = std::thread::hardware_concurrency() <= 0 ? 1 : std::thread::hardware_concurrency();
+
+				// Zstandard only. Dictionary that file was compressed with
+				const zstd::Dictionary* dictionary = nullptr;
+			};
+
 			void decompress(Stream& input, Stream& output, MetadataAssetArray* metadata = nullptr);
+			void decompress(Stream& input, Stream& output, DecompressorContext& context, MetadataAssetArray* metadata = nullptr);
+
+			/// <summary>
+			/// Decompresses only specified range of file data.
+			/// Zstandard files with seek table decompress only frames that overlap range,
+			/// other files are decompressed from the start and decompression stops at the end of range.
+			/// </summary>
+			void decompress_range(Stream& input, Stream& output, size_t offset, size_t length);
+			void decompress_range(Stream& input, Stream& output, DecompressorContext& context, size_t offset, size_t length);
 		}
 
 		namespace Compressor
 		{
+			// Objective for Signature::Auto
+			struct AutoSelection
+			{
+				// Codec with smallest output is selected among codecs that decompress samples at least with this speed (MB/s).
+				// If no codec is fast enough, the fastest one is selected. Value 0 means no speed limit
+				double min_decode_speed = 0.0;
+
+				// Number and size of blocks that are taken evenly from input and compressed by every codec
+				uint32_t samples_count = 4;
+				size_t sample_size = 256 * 1024;
+			};
+
 			struct CompressorContext
 			{
 				Signature signature = Signature::Zstandard;
+				AutoSelection auto_selection;
 
 				bool write_assets = false;
 				//MetadataAssetArray assets;
 
+				// Zstandard only. Splits data into independent frames of this size, so it can be decompressed in parallel.
+				// Value 0 means that data is compressed into a single frame
+				size_t frame_size = 0;
+
+				// Zstandard only. Writes table with position of every frame, so any range of data can be decompressed without decompressing data before it.
+				// Used only when frame_size is set
+				bool write_seek_table = false;
+
+				// Zstandard only. Files compressed with dictionary can be decompressed only with the same dictionary
+				const zstd::Dictionary* dictionary = nullptr;
+
+				// LZHAM only. Allows dictionary bigger than SCLZ_DEFAULT_DICT_SIZE_LOG2 for large inputs.
+				// Dictionary size is written to header, bigger dictionary needs more memory for decompression
+				bool lzham_large_dictionary = false;
+
 				uint32_t threads_count = std::thread::hardware_concurrency() <= 0 ? 1 : std::thread::hardware_concurrency();
 			};
 
 			void compress(Stream& input, Stream& output, CompressorContext& context);
+
+			/// <summary>
+			/// Compresses samples of input with every codec, measures compression ratio and decompression speed
+			/// and selects codec by objective from context.auto_selection. Stream position is restored after reading.
+			/// </summary>
+			Signature select_signature(Stream& input, CompressorContext& context);
 		}
 	}
 }
\ No newline at end of file
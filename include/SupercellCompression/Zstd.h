@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>
+
 #pragma region Forward Declaration
 
 struct ZSTD_CCtx_s;
@@ -9,7 +11,29 @@ struct ZSTD_DCtx_s;
 typedef struct ZSTD_DCtx_s ZSTD_DCtx;
 typedef ZSTD_DCtx ZSTD_DStream;
 
+struct ZSTD_CDict_s;
+typedef struct ZSTD_CDict_s ZSTD_CDict;
+
+struct ZSTD_DDict_s;
+typedef struct ZSTD_DDict_s ZSTD_DDict;
+
+#pragma endregion
+
+namespace sc
+{
+	namespace zstd
+	{
+#pragma region Constants
+		// Zstandard seekable format
+		static const uint32_t SKIPPABLE_FRAME_MAGIC = 0x184D2A5E;
+		static const uint32_t SEEKABLE_MAGIC = 0x8F92EAB1;
+		static const uint32_t SKIPPABLE_FRAME_HEADER_SIZE = 8;
+		static const uint32_t SEEK_TABLE_ENTRY_SIZE = 8;
+		static const uint32_t SEEK_TABLE_FOOTER_SIZE = 9;
 #pragma endregion
+	}
+}
 
+#include "Zstd/Dictionary.h"
 #include "Zstd/Compressor.h"
 #include "Zstd/Decompressor.h"
\ No newline at end of file
@@ -1,7 +1,10 @@
 #pragma once
+#include "SupercellCompression/Zstd.h"
 #include "SupercellCompression/interface/CompressionInterface.h"
 
+#include <chrono>
 #include <thread>
+#include <vector>
 
 namespace sc
 {
@@ -165,6 +168,42 @@ namespace sc
 				   9: full window;  8: w/2;  7: w/4;  6: w/8;  5:w/16;  4: w/32;  3:w/64;  2:w/128;  1:no overlap;  0:default
 				   default value varies between 6 and 9, depending on strategy */
 				int overlap_log = 0;
+
+				/* Splits input into independent frames of this size, so they can be decompressed in parallel.
+				   Every frame is compressed from scratch, so small values decrease compression ratio.
+				   Special: value 0 means whole input is compressed into a single frame. */
+				size_t frame_size = 0;
+
+				/* Writes a seek table with compressed and decompressed size of every frame
+				   into a skippable frame at the end of data (Zstandard seekable format).
+				   Regular decompressors skip it. Used only when frame_size is set. */
+				bool write_seek_table = false;
+
+				/* Prebuilt dictionary that is used for every frame. Dictionary is only referenced,
+				   so it must outlive compressor. The same dictionary is required for decompression.
+				   Special: nullptr means no dictionary. */
+				const zstd::Dictionary* dictionary = nullptr;
+
+				/* Delta mode. Previous version of data that is referenced as a prefix of every frame,
+				   so only changes from it are stored. Long distance matching is enabled and window is enlarged
+				   to cover whole reference. Reference is only referenced, so it must outlive compressor.
+				   The same reference is required for decompression. Replaces dictionary.
+				   Special: nullptr means no reference. */
+				const uint8_t* reference = nullptr;
+				size_t reference_length = 0;
+
+				/* Attempts to fit compressed blocks into approximately this size, so decompressor can start
+				   decoding live data earlier. Small values decrease compression ratio.
+				   Special: value 0 means no target. */
+				size_t target_block_size = 0;
+
+				/* Live streaming with compress_chunk. Compressed data is flushed to output when this number of bytes
+				   was given since last flush. Special: value 0 means no size threshold. */
+				size_t flush_size = 0;
+
+				/* Live streaming with compress_chunk. Compressed data is flushed to output when this number of milliseconds
+				   passed since last flush. Special: value 0 means no time threshold. */
+				uint32_t flush_interval = 0;
 			};
 		public:
 			Zstd(Props& props);
@@ -172,9 +211,58 @@ namespace sc
 
 			void compress_stream(Stream& input, Stream& output) override;
 
+			/// <summary>
+			/// Compresses next chunk of live data. Output is flushed when size or time threshold from props is reached,
+			/// so consumer can decompress data without waiting for the end of frame.
+			/// Thresholds are only checked when chunk is given, so during producer stalls caller must call flush() itself.
+			/// </summary>
+			/// <param name="output"></param>
+			/// <param name="data">Chunk of data from producer</param>
+			/// <param name="length">Length of chunk</param>
+			void compress_chunk(Stream& output, const uint8_t* data, size_t length);
+
+			/// <summary>
+			/// Writes to output everything that was given to compress_chunk. Frame stays open.
+			/// </summary>
+			void flush(Stream& output);
+
+			/// <summary>
+			/// Finishes frame that was started by compress_chunk. Next chunk starts a new frame.
+			/// </summary>
+			void end(Stream& output);
+
+		private:
+			// Compresses exactly length bytes from input into a single frame. Returns compressed frame length
+			size_t compress_frame(Stream& input, Stream& output, size_t length);
+
+			// Compresses frame from memory input without copying it to stream buffer
+			size_t compress_frame_memory(Stream& input, Stream& output, size_t length);
+
+			void write_seek_table(Stream& output, const std::vector<uint32_t>& compressed_sizes, const std::vector<uint32_t>& decompressed_sizes);
+
+			// Starts live frame if it is not started yet
+			void start_live_frame();
+
+			// Passes chunk to compressor with specified ZSTD_EndDirective and writes everything compressor gives back
+			void compress_live(Stream& output, const uint8_t* data, size_t length, int directive);
+
 		private:
 			ZSTD_CCtx* m_context = nullptr;
 
+			size_t m_frame_size = 0;
+			bool m_write_seek_table = false;
+
+			const uint8_t* m_reference = nullptr;
+			size_t m_reference_length = 0;
+
+			// -- Live Streaming --
+			size_t m_flush_size = 0;
+			std::chrono::milliseconds m_flush_interval{ 0 };
+
+			bool m_live_frame = false;
+			size_t m_unflushed_length = 0;
+			std::chrono::steady_clock::time_point m_last_flush;
+
 			// -- Stream Buffer --
 			const size_t Input_Buffer_Size;
 			const size_t Output_Buffer_Size;
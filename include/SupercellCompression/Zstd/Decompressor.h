@@ -2,21 +2,95 @@
 #include "SupercellCompression/Zstd.h"
 #include "SupercellCompression/interface/DecompressionInterface.h"
 
+#include <thread>
+#include <vector>
+
 namespace sc
 {
 	namespace Decompressor
 	{
 		class Zstd : public DecompressionInterface
 		{
+		public:
+			struct Props
+			{
+				/* Data with several independent frames is decompressed in parallel by this number of threads.
+				   Used only when input is in memory and every frame stores its content size. */
+				uint32_t threads_count = std::thread::hardware_concurrency() == 0 ? 1 : std::thread::hardware_concurrency();
+
+				/* Dictionary that data was compressed with. Dictionary is only referenced and shared
+				   between all decompression threads, so it must outlive decompressor. */
+				const zstd::Dictionary* dictionary = nullptr;
+
+				/* Delta mode. The same previous version of data that was referenced by compressor.
+				   Reference is only referenced, so it must outlive decompressor. */
+				const uint8_t* reference = nullptr;
+				size_t reference_length = 0;
+			};
+
 		public:
 			Zstd();
+			Zstd(Props& props);
 			~Zstd();
 
 			void decompress_stream(Stream& input, Stream& output) override;
 
+			/// <summary>
+			/// Decompresses only specified range of data. If data has a seek table, only frames that overlap range are decompressed,
+			/// otherwise data is decompressed sequentially until the end of range.
+			/// </summary>
+			/// <param name="input"></param>
+			/// <param name="output"></param>
+			/// <param name="offset">Offset in decompressed data</param>
+			/// <param name="length">Length of range in decompressed data</param>
+			/// <param name="input_length">Length of compressed data from input position. Seek table is read from its end and data after it is ignored</param>
+			void decompress_range(Stream& input, Stream& output, size_t offset, size_t length, size_t input_length = SIZE_MAX);
+
+			/// <summary>
+			/// Decompresses next chunk of live data as it arrives. Chunk can end in any place of frame,
+			/// everything that can be decoded from data received so far is written to output.
+			/// </summary>
+			/// <param name="output"></param>
+			/// <param name="data">Chunk of compressed data</param>
+			/// <param name="length">Length of chunk</param>
+			/// <returns>True if chunk ended exactly on the end of frame</returns>
+			bool decompress_chunk(Stream& output, const uint8_t* data, size_t length);
+
+		private:
+			struct FrameEntry
+			{
+				size_t offset;
+				size_t length;
+
+				size_t unpacked_offset;
+				size_t unpacked_length;
+			};
+
+			// Decompresses concatenated frames from memory with single call per frame, in parallel if several threads are allowed.
+			// Returns false if data can not be decompressed that way
+			bool decompress_frames(Stream& input, Stream& output);
+
+			// Sequential decompression that writes to output only data inside of range. Reads at most input_length bytes of input
+			void decompress_stream_range(Stream& input, Stream& output, size_t offset, size_t length, size_t input_length);
+
+			// Prepares context for decompression of next frame. Reference prefix is used only for one frame
+			void prepare_frame(ZSTD_DCtx* context) const;
+
+			// Reads seek table from the end of data_length bytes of input. Returns false if data has no seek table
+			static bool read_seek_table(Stream& input, size_t data_length, std::vector<FrameEntry>& frames);
+
 		private:
 			ZSTD_DStream* m_context;
 
+			uint32_t m_threads_count = 1;
+			const zstd::Dictionary* m_dictionary = nullptr;
+
+			const uint8_t* m_reference = nullptr;
+			size_t m_reference_length = 0;
+
+			// Live chunk decompression is in the middle of frame
+			bool m_live_frame = false;
+
 			// -- Stream Buffer --
 			const size_t Input_Buffer_Size;
 			const size_t Output_Buffer_Size;
@@ -25,4 +99,4 @@ namespace sc
 			uint8_t* m_output_buffer = nullptr;
 		};
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+namespace sc
+{
+	namespace zstd
+	{
+		/// <summary>
+		/// Trains dictionary on a set of small and similar samples (like csv tables or shape files).
+		/// Dictionary gives better ratio and faster decompression when data is compressed in small pieces.
+		/// </summary>
+		/// <param name="samples">Sample files. Zstandard needs at least several samples, usually hundreds</param>
+		/// <param name="capacity">Maximum size of dictionary in bytes</param>
+		/// <returns>Dictionary content that can be saved to file and loaded to Dictionary</returns>
+		std::vector<uint8_t> train_dictionary(const std::vector<std::vector<uint8_t>>& samples, size_t capacity = 112640);
+
+		/// <summary>
+		/// Digested compression and decompression dictionaries. Dictionary is read-only after creation,
+		/// so one instance can be shared between compressors and decompressors in several threads.
+		/// Dictionary must outlive all compressors and decompressors that use it.
+		/// </summary>
+		class Dictionary
+		{
+		public:
+			/// <summary>
+			/// Digests dictionary content. Content is copied, so buffer can be freed after construction.
+			/// </summary>
+			/// <param name="data">Dictionary content from train_dictionary or any raw content</param>
+			/// <param name="length">Length of dictionary content</param>
+			/// <param name="compression_level">Compression dictionary is prepared for this level.
+			/// Compressors with another level load dictionary content for their own level instead</param>
+			Dictionary(const uint8_t* data, size_t length, int compression_level = 3);
+			~Dictionary();
+
+			Dictionary(const Dictionary&) = delete;
+			Dictionary& operator=(const Dictionary&) = delete;
+
+		public:
+			const ZSTD_CDict* compress_dictionary() const
+			{
+				return m_compress_dictionary;
+			}
+
+			const ZSTD_DDict* decompress_dictionary() const
+			{
+				return m_decompress_dictionary;
+			}
+
+			// Dictionary ID that is written to frame header. Zero for raw content dictionaries
+			uint32_t id() const;
+
+			// Level for which compression dictionary is prepared
+			int compression_level() const
+			{
+				return m_compression_level;
+			}
+
+			const uint8_t* data() const
+			{
+				return m_content.data();
+			}
+
+			size_t length() const
+			{
+				return m_content.size();
+			}
+
+		private:
+			std::vector<uint8_t> m_content;
+			int m_compression_level;
+
+			ZSTD_CDict* m_compress_dictionary = nullptr;
+			ZSTD_DDict* m_decompress_dictionary = nullptr;
+		};
+	}
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "exception/GeneralRuntimeException.h"
+
+namespace sc
+{
+	SC_CONSTRUCT_PARENT_EXCEPTION(GeneralRuntimeException, MappedFileGeneralException, "Failed to make memory mapped file operation");
+
+	SC_CONSTRUCT_CHILD_EXCEPTION(MappedFileGeneralException, MappedFileOpenException, "Failed to open file for memory mapping");
+	SC_CONSTRUCT_CHILD_EXCEPTION(MappedFileGeneralException, MappedFileResizeException, "Failed to resize memory mapped file");
+	SC_CONSTRUCT_CHILD_EXCEPTION(MappedFileGeneralException, MappedFileMapException, "Failed to map file to memory");
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "exception/GeneralRuntimeException.h"
+
+namespace sc
+{
+	SC_CONSTRUCT_PARENT_EXCEPTION(GeneralRuntimeException, ScGeneralException, "Failed to make SC operation");
+
+	SC_CONSTRUCT_CHILD_EXCEPTION(ScGeneralException, ScUnknownVersionException, "SC file has unknown version");
+
+#pragma region Decompress
+	SC_CONSTRUCT_PARENT_EXCEPTION(ScGeneralException, ScDecompressException, "Failed to decompress SC data");
+
+	SC_CONSTRUCT_CHILD_EXCEPTION(ScDecompressException, ScCorruptedHashException, "Hash of decompressed SC data does not match hash from header");
+
+#pragma endregion
+}
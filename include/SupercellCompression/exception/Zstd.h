@@ -20,5 +20,14 @@ namespace sc
 
 	SC_CONSTRUCT_CHILD_EXCEPTION(ZstdCompressException, ZstdCompressInitException, "Failed to initialize ZSTD compress context");
 
+#pragma endregion
+
+#pragma region Dictionary
+
+	SC_CONSTRUCT_PARENT_EXCEPTION(ZstdGeneralException, ZstdDictionaryException, "Failed to make ZSTD dictionary operation");
+
+	SC_CONSTRUCT_CHILD_EXCEPTION(ZstdDictionaryException, ZstdDictionaryTrainException, "Failed to train ZSTD dictionary");
+	SC_CONSTRUCT_CHILD_EXCEPTION(ZstdDictionaryException, ZstdDictionaryLoadException, "Failed to load ZSTD dictionary");
+
 #pragma endregion
 }
\ No newline at end of file
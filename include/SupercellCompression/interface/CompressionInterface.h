@@ -1,17 +1,44 @@
 #pragma once
 #include "io/stream.h"
 
+#include <functional>
+
 namespace sc
 {
 	namespace Compressor
 	{
 		class CompressionInterface
 		{
+		public:
+			// Receives every chunk of input data right after compressor has read it
+			typedef std::function<void(const uint8_t* data, size_t length)> ChunkCallback;
+
 		public:
 			virtual ~CompressionInterface() = default;
 
 		public:
 			virtual void compress_stream(Stream& input, Stream& output) = 0;
+
+			void set_input_callback(ChunkCallback callback)
+			{
+				m_input_callback = callback;
+			}
+
+		protected:
+			size_t read_input(Stream& input, void* data, size_t length)
+			{
+				size_t readed_bytes = input.read(data, length);
+
+				if (m_input_callback && readed_bytes)
+				{
+					m_input_callback((const uint8_t*)data, readed_bytes);
+				}
+
+				return readed_bytes;
+			}
+
+		protected:
+			ChunkCallback m_input_callback;
 		};
 	}
-}
\ No newline at end of file
+}
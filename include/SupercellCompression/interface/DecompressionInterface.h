@@ -1,5 +1,8 @@
 #pragma once
 #include "io/stream.h"
+#include "io/buffer_stream.h"
+
+#include <functional>
 
 namespace sc
 {
@@ -7,11 +10,88 @@ namespace sc
 	{
 		class DecompressionInterface
 		{
+		public:
+			// Receives every chunk of decompressed data right after decompressor has written it to output
+			typedef std::function<void(const uint8_t* data, size_t length)> ChunkCallback;
+
+			// Decompressed length from header is trusted only up to this ratio to compressed length.
+			// Longer output is grown while streaming, so corrupted headers can not force huge allocations
+			static const size_t Max_Reserve_Ratio = 1024;
+
+			// Decompressed length up to this size is always trusted
+			static const size_t Min_Reserve_Limit = 16 * 1024 * 1024;
+
 		public:
 			virtual ~DecompressionInterface() = default;
 
 		public:
 			virtual void decompress_stream(Stream& input, Stream& output) = 0;
+
+			void set_output_callback(ChunkCallback callback)
+			{
+				m_output_callback = callback;
+			}
+
+			// Returns true if length bytes of decompressed data from header can be allocated at once
+			static bool can_reserve(size_t length, size_t compressed_length)
+			{
+				if (Min_Reserve_Limit >= length) return true;
+
+				return compressed_length >= length / Max_Reserve_Ratio;
+			}
+
+		protected:
+			size_t write_output(Stream& output, const uint8_t* data, size_t length)
+			{
+				size_t written_bytes = output.write(data, length);
+
+				if (m_output_callback && length)
+				{
+					m_output_callback(data, length);
+				}
+
+				return written_bytes;
+			}
+
+			// Returns memory at current output position where length bytes of decompressed data can be written directly.
+			// Buffer streams are resized once to required length. Returns nullptr if output can not provide such memory
+			// or if length is too big for compressed_length bytes of input.
+			static uint8_t* reserve_output(Stream& output, size_t length, size_t compressed_length)
+			{
+				if (!can_reserve(length, compressed_length))
+				{
+					return nullptr;
+				}
+
+				size_t position = output.position();
+
+				BufferStream* buffer = dynamic_cast<BufferStream*>(&output);
+				if (buffer && position + length > buffer->length())
+				{
+					buffer->resize(position + length);
+				}
+
+				if (output.data() == nullptr || position + length > output.length())
+				{
+					return nullptr;
+				}
+
+				return (uint8_t*)output.data() + position;
+			}
+
+			// Moves output position after data that was written to memory from reserve_output
+			void commit_output(Stream& output, const uint8_t* data, size_t length)
+			{
+				output.seek(length, Seek::Add);
+
+				if (m_output_callback && length)
+				{
+					m_output_callback(data, length);
+				}
+			}
+
+		protected:
+			ChunkCallback m_output_callback;
 		};
 	}
-}
\ No newline at end of file
+}
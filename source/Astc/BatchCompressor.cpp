@@ -0,0 +1,192 @@
+#include "SupercellCompression/Astc.h"
+
+#include <astcenc.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "memory/alloc.h"
+#include "../Parallel.h"
+#include "SupercellCompression/exception/Astc.h"
+
+using namespace sc::astc;
+
+namespace sc
+{
+	namespace Compressor
+	{
+		// Size of ASTC block in bytes is the same for every block size
+		static const size_t Block_Size = 16;
+
+		// Image pixels are read by encoder as 4 bytes
+		static const size_t Pixel_Size = 4;
+
+		static const uint32_t Job_Blocks_Count = 4096;
+
+		AstcBatch::AstcBatch(Props& props)
+		{
+			m_profile = props.profile;
+			m_quality = props.quality;
+			m_threads_count = props.threads_count == 0 ? 1 : props.threads_count;
+			m_job_block_rows = props.job_block_rows;
+			m_pool = new ThreadPool(m_threads_count);
+		}
+
+		AstcBatch::~AstcBatch()
+		{
+			delete m_pool;
+
+			for (auto& [key, contexts] : m_contexts)
+			{
+				for (astcenc_context* context : contexts)
+				{
+					if (context)
+					{
+						astcenc_context_free(context);
+					}
+				}
+			}
+		}
+
+		int AstcBatch::get_context(uint8_t blocks_x, uint8_t blocks_y, uint32_t thread_index, astcenc_context*& context)
+		{
+			// Slots are created before threads start and every thread uses only its own slot
+			astcenc_context*& slot = m_contexts.at(context_key(blocks_x, blocks_y))[thread_index];
+			if (slot)
+			{
+				context = slot;
+				return ASTCENC_SUCCESS;
+			}
+
+			astcenc_config config;
+			astcenc_error status = astcenc_config_init(
+				(astcenc_profile)m_profile,
+				blocks_x, blocks_y, 1,
+				float(m_quality), 0, &config
+			);
+
+			if (status != ASTCENC_SUCCESS) return status;
+
+			status = astcenc_context_alloc(&config, 1, &slot);
+
+			if (status != ASTCENC_SUCCESS) return status;
+
+			context = slot;
+			return ASTCENC_SUCCESS;
+		}
+
+		void AstcBatch::compress(std::vector<Entry>& entries)
+		{
+			std::vector<Job> jobs;
+			std::vector<uint8_t*> blocks(entries.size(), nullptr);
+			std::vector<size_t> blocks_length(entries.size(), 0);
+
+			for (size_t i = 0; entries.size() > i; i++)
+			{
+				Entry& entry = entries[i];
+				if (entry.width == 0 || entry.height == 0)
+				{
+					continue;
+				}
+
+				uint32_t xblocks = (entry.width + entry.blocks_x - 1) / entry.blocks_x;
+				uint32_t yblocks = (entry.height + entry.blocks_y - 1) / entry.blocks_y;
+
+				blocks_length[i] = (size_t)xblocks * yblocks * Block_Size;
+				blocks[i] = memalloc(blocks_length[i]);
+
+				uint32_t job_rows = m_job_block_rows;
+				if (job_rows == 0)
+				{
+					job_rows = std::max<uint32_t>(1, Job_Blocks_Count / xblocks);
+				}
+
+				for (uint32_t row = 0; yblocks > row; row += job_rows)
+				{
+					jobs.push_back({ i, row, std::min(job_rows, yblocks - row) });
+				}
+
+				// Slots for contexts are created before threads start, contexts itself are allocated by threads on first use
+				std::vector<astcenc_context*>& contexts = m_contexts[context_key(entry.blocks_x, entry.blocks_y)];
+				contexts.resize(m_threads_count, nullptr);
+			}
+
+			std::atomic<size_t> next_job = 0;
+			std::atomic<bool> failed = false;
+			astcenc_error error = ASTCENC_SUCCESS;
+
+			uint32_t threads_count = (uint32_t)std::min<size_t>(m_threads_count, jobs.size());
+			m_pool->run(threads_count, [&](uint32_t thread_index)
+				{
+					while (!failed)
+					{
+						size_t job_index = next_job++;
+						if (job_index >= jobs.size())
+						{
+							break;
+						}
+
+						const Job& job = jobs[job_index];
+						const Entry& entry = entries[job.entry_index];
+
+						uint32_t xblocks = (entry.width + entry.blocks_x - 1) / entry.blocks_x;
+						uint32_t first_line = job.first_row * entry.blocks_y;
+						uint32_t lines_count = std::min<uint32_t>(job.rows_count * entry.blocks_y, entry.height - first_line);
+
+						// Band of block rows is compressed as separate image, its blocks are the same as blocks of whole image
+						uint8_t* band_data = (uint8_t*)entry.data + (size_t)first_line * entry.width * Pixel_Size;
+
+						astcenc_image band{};
+						band.dim_x = entry.width;
+						band.dim_y = lines_count;
+						band.dim_z = 1;
+						band.data = (void**)&band_data;
+						band.data_type = ASTCENC_TYPE_U8;
+
+						astcenc_swizzle swizzle = get_swizzle(entry.type);
+
+						uint8_t* band_blocks = blocks[job.entry_index] + (size_t)job.first_row * xblocks * Block_Size;
+						size_t band_blocks_length = (size_t)job.rows_count * xblocks * Block_Size;
+
+						astcenc_context* context = nullptr;
+						astcenc_error status = (astcenc_error)get_context(entry.blocks_x, entry.blocks_y, thread_index, context);
+						if (status == ASTCENC_SUCCESS)
+						{
+							status = astcenc_compress_image(context, &band, &swizzle, band_blocks, band_blocks_length, 0);
+							astcenc_compress_reset(context);
+						}
+
+						if (status != ASTCENC_SUCCESS && !failed.exchange(true))
+						{
+							error = status;
+						}
+					}
+				}
+			);
+
+			if (!failed)
+			{
+				for (size_t i = 0; entries.size() > i; i++)
+				{
+					if (blocks[i] && entries[i].output)
+					{
+						entries[i].output->write(blocks[i], blocks_length[i]);
+					}
+				}
+			}
+
+			for (uint8_t* data : blocks)
+			{
+				if (data)
+				{
+					free(data);
+				}
+			}
+
+			if (failed)
+			{
+				throw AstcGeneralException(error);
+			}
+		}
+	}
+}
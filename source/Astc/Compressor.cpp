@@ -2,7 +2,10 @@
 
 #include <astcenc.h>
 
+#include <algorithm>
+
 #include "memory/alloc.h"
+#include "../Parallel.h"
 #include "SupercellCompression/exception/Astc.h"
 #include "exception/image/BasicExceptions.h"
 
@@ -58,13 +61,17 @@ namespace sc
 
 			if (status != astcenc_error::ASTCENC_SUCCESS) throw AstcGeneralException(status);
 
-			status = astcenc_context_alloc(m_config, props.threads_count, &m_context);
+			m_threads_count = props.threads_count == 0 ? 1 : props.threads_count;
+			status = astcenc_context_alloc(m_config, m_threads_count, &m_context);
 
 			if (status != astcenc_error::ASTCENC_SUCCESS) throw AstcGeneralException(status);
+
+			m_pool = new ThreadPool(m_threads_count);
 		};
 
 		Astc::~Astc()
 		{
+			delete m_pool;
 			astcenc_context_free(m_context);
 			delete m_config;
 		}
@@ -91,8 +98,7 @@ namespace sc
 			size_t data_size = xblocks * yblocks * 16;
 			uint8_t* data = memalloc(data_size);
 
-			astcenc_error status = astcenc_compress_image(m_context, &encoder_image, &swizzle, data, data_size, 0);
-
+			astcenc_error status = (astcenc_error)compress_blocks(encoder_image, swizzle, data, data_size);
 			if (status != ASTCENC_SUCCESS)
 			{
 				free(data);
@@ -102,5 +108,114 @@ namespace sc
 			output.write(data, data_size);
 			free(data);
 		};
+
+		void Astc::compress_image_striped(
+			uint16_t width, uint16_t height, Image::BasePixelType type,
+			const RowProducer& producer, Stream& output,
+			uint32_t band_block_rows
+		)
+		{
+			const size_t block_size = 16;
+			const size_t pixel_size = 4;
+
+			if (band_block_rows == 0) band_block_rows = 1;
+
+			astcenc_swizzle swizzle = get_swizzle(type);
+
+			const unsigned int& blocks_x = m_config->block_x;
+			const unsigned int& blocks_y = m_config->block_y;
+
+			uint32_t xblocks = (width + blocks_x - 1) / blocks_x;
+			uint32_t yblocks = (height + blocks_y - 1) / blocks_y;
+			if (xblocks == 0 || yblocks == 0) return;
+
+			band_block_rows = std::min(band_block_rows, yblocks);
+
+			// Band height is a multiple of block height, so band blocks are the same as blocks of whole image
+			uint8_t* pixels = memalloc((size_t)width * band_block_rows * blocks_y * pixel_size);
+			uint8_t* blocks = memalloc((size_t)xblocks * band_block_rows * block_size);
+
+			try
+			{
+				for (uint32_t row = 0; yblocks > row; row += band_block_rows)
+				{
+					uint32_t rows_count = std::min(band_block_rows, yblocks - row);
+					uint32_t first_line = row * blocks_y;
+					uint32_t lines_count = std::min<uint32_t>(rows_count * blocks_y, height - first_line);
+
+					producer(first_line, lines_count, pixels);
+
+					astcenc_image band{};
+					band.dim_x = width;
+					band.dim_y = lines_count;
+					band.dim_z = 1;
+					band.data = (void**)&pixels;
+					band.data_type = ASTCENC_TYPE_U8;
+
+					size_t band_size = (size_t)xblocks * rows_count * block_size;
+					astcenc_error status = (astcenc_error)compress_blocks(band, swizzle, blocks, band_size);
+					if (status != ASTCENC_SUCCESS)
+					{
+						throw AstcGeneralException(status);
+					}
+
+					output.write(blocks, band_size);
+				}
+			}
+			catch (...)
+			{
+				free(pixels);
+				free(blocks);
+				throw;
+			}
+
+			free(pixels);
+			free(blocks);
+		}
+
+		void Astc::compress_image_striped(
+			uint16_t width, uint16_t height, Image::BasePixelType type,
+			Stream& input, Stream& output,
+			uint32_t band_block_rows
+		)
+		{
+			const size_t pixel_size = 4;
+
+			compress_image_striped(width, height, type,
+				[&input, width](uint32_t, uint32_t rows_count, uint8_t* rows)
+				{
+					size_t rows_length = (size_t)width * rows_count * pixel_size;
+					if (input.read(rows, rows_length) != rows_length)
+					{
+						throw AstcGeneralException(ASTCENC_ERR_BAD_PARAM);
+					}
+				},
+				output, band_block_rows
+			);
+		}
+
+		int Astc::compress_blocks(astcenc_image& image, astcenc_swizzle& swizzle, uint8_t* data, size_t data_size)
+		{
+			// Encoder splits image blocks between all threads that call it with different thread index
+			std::vector<astcenc_error> statuses(m_threads_count, ASTCENC_SUCCESS);
+			m_pool->run(m_threads_count, [&](uint32_t thread_index)
+				{
+					statuses[thread_index] = astcenc_compress_image(m_context, &image, &swizzle, data, data_size, thread_index);
+				}
+			);
+
+			// Context must be reset before next image
+			astcenc_compress_reset(m_context);
+
+			for (astcenc_error status : statuses)
+			{
+				if (status != ASTCENC_SUCCESS)
+				{
+					return status;
+				}
+			}
+
+			return ASTCENC_SUCCESS;
+		}
 	}
 }
\ No newline at end of file
@@ -3,9 +3,758 @@
 #include <astcenc.h>
 
 #include "memory/alloc.h"
+#include "../Parallel.h"
 #include "SupercellCompression/exception/Astc.h"
 #include "exception/io/BinariesExceptions.h"
 
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+// Void-extent block stores one color for all its texels as four 16-bit values
+static bool is_void_extent_block(const uint8_t* block)
+{
+	return block[0] == 0xFC && (block[1] & 0x01) != 0;
+}
+
+static float half_to_float(uint16_t value)
+{
+	int exponent = (value >> 10) & 0x1F;
+	int mantissa = value & 0x3FF;
+	float result = exponent == 0 ? std::ldexp((float)mantissa, -24) : std::ldexp((float)(mantissa | 0x400), exponent - 25);
+	return (value & 0x8000) ? -result : result;
+}
+
+static uint8_t float_to_unorm8(float value)
+{
+	value = std::min(std::max(value, 0.0f), 1.0f);
+	return static_cast<uint8_t>(value * 255.0f + 0.5f);
+}
+
+// Same color as decoder uses for error blocks
+static void error_color(uint8_t* pixel)
+{
+	pixel[0] = 0xFF; pixel[1] = 0x00; pixel[2] = 0xFF; pixel[3] = 0xFF;
+}
+
+// Average color of block from astcenc block info. Average of interpolated texels of partition equals interpolation of its endpoints by average weight
+static void block_info_average_color(astcenc_context* context, const uint8_t* block, uint8_t* pixel)
+{
+	astcenc_block_info info{};
+	astcenc_error status = astcenc_get_block_info(context, block, &info);
+	if (status != ASTCENC_SUCCESS || info.is_error_block || info.is_constant_block)
+	{
+		error_color(pixel);
+		return;
+	}
+
+	float texels_count[4] = { 0.0f };
+	float weights_plane1[4] = { 0.0f };
+	float weights_plane2[4] = { 0.0f };
+
+	for (unsigned int texel = 0; info.texel_count > texel; texel++)
+	{
+		uint8_t partition = info.partition_assignment[texel];
+		texels_count[partition] += 1.0f;
+		weights_plane1[partition] += info.weight_values_plane1[texel];
+		weights_plane2[partition] += info.weight_values_plane2[texel];
+	}
+
+	for (uint8_t channel = 0; 4 > channel; channel++)
+	{
+		bool second_plane = info.is_dual_plane_block && info.dual_plane_component == channel;
+
+		float color = 0.0f;
+		for (unsigned int partition = 0; info.partition_count > partition; partition++)
+		{
+			if (texels_count[partition] == 0.0f) continue;
+
+			float weight = (second_plane ? weights_plane2[partition] : weights_plane1[partition]) / texels_count[partition];
+			float endpoint0 = info.color_endpoints[partition][0][channel];
+			float endpoint1 = info.color_endpoints[partition][1][channel];
+
+			color += (endpoint0 + (endpoint1 - endpoint0) * weight) * texels_count[partition];
+		}
+
+		pixel[channel] = float_to_unorm8(color / (float)info.texel_count);
+	}
+}
+
+#pragma region Block Bitstream
+// Integer sequence encoding of every quantization level: number of trits, quints and bits of each value
+struct QuantMode
+{
+	uint8_t trits;
+	uint8_t quints;
+	uint8_t bits;
+};
+
+// Levels with 2, 3, 4, 5, 6, 8, 10, 12, 16, 20, 24, 32, 40, 48, 64, 80, 96, 128, 160, 192 and 256 values
+static const QuantMode Quant_Modes[] = {
+	{ 0, 0, 1 }, { 1, 0, 0 }, { 0, 0, 2 }, { 0, 1, 0 }, { 1, 0, 1 }, { 0, 0, 3 }, { 0, 1, 1 },
+	{ 1, 0, 2 }, { 0, 0, 4 }, { 0, 1, 2 }, { 1, 0, 3 }, { 0, 0, 5 }, { 0, 1, 3 }, { 1, 0, 4 },
+	{ 0, 0, 6 }, { 0, 1, 4 }, { 1, 0, 5 }, { 0, 0, 7 }, { 0, 1, 5 }, { 1, 0, 6 }, { 0, 0, 8 }
+};
+
+static const uint8_t Quant_Modes_Count = sizeof(Quant_Modes) / sizeof(QuantMode);
+
+// Color endpoints must have at least 6 levels
+static const uint8_t Min_Color_Quant = 4;
+
+// Unquantization of trit and quint values: masks of value bits b, c, d, e, f in B and multiplier C for every number of bits
+static const uint16_t Color_Trit_B[7][5] = {
+	{}, {}, { 0x116 }, { 0x085, 0x10A }, { 0x041, 0x082, 0x104 },
+	{ 0x020, 0x040, 0x081, 0x102 }, { 0x010, 0x020, 0x040, 0x080, 0x101 }
+};
+static const uint8_t Color_Trit_C[7] = { 0, 204, 93, 44, 22, 11, 5 };
+
+static const uint16_t Color_Quint_B[6][4] = {
+	{}, {}, { 0x10C }, { 0x082, 0x105 }, { 0x040, 0x081, 0x102 }, { 0x020, 0x040, 0x080, 0x101 }
+};
+static const uint8_t Color_Quint_C[6] = { 0, 113, 54, 26, 13, 6 };
+
+static const uint16_t Weight_Trit_B[4][2] = { {}, {}, { 0x45 }, { 0x21, 0x42 } };
+static const uint8_t Weight_Trit_C[4] = { 0, 50, 23, 11 };
+
+static const uint16_t Weight_Quint_B[3][1] = { {}, {}, { 0x43 } };
+static const uint8_t Weight_Quint_C[3] = { 0, 28, 13 };
+
+static uint32_t ise_length(uint32_t count, const QuantMode& mode)
+{
+	return count * mode.bits + (mode.trits ? (8 * count + 4) / 5 : 0) + (mode.quints ? (7 * count + 2) / 3 : 0);
+}
+
+// Reads bits of block from lowest one. Bits at end position and after it are read as zero
+static uint32_t read_bits(const uint8_t* block, uint32_t& position, uint32_t end, uint32_t count)
+{
+	uint32_t result = 0;
+	for (uint32_t i = 0; count > i; i++, position++)
+	{
+		if (end > position)
+		{
+			result |= ((block[position >> 3] >> (position & 7)) & 1u) << i;
+		}
+	}
+
+	return result;
+}
+
+static void decode_trits(uint32_t T, uint32_t trits[5])
+{
+	uint32_t C;
+	if (((T >> 2) & 7) == 7)
+	{
+		C = ((T >> 5) << 2) | (T & 3);
+		trits[4] = 2;
+		trits[3] = 2;
+	}
+	else
+	{
+		C = T & 0x1F;
+		if (((T >> 5) & 3) == 3)
+		{
+			trits[4] = 2;
+			trits[3] = (T >> 7) & 1;
+		}
+		else
+		{
+			trits[4] = (T >> 7) & 1;
+			trits[3] = (T >> 5) & 3;
+		}
+	}
+
+	if ((C & 3) == 3)
+	{
+		trits[2] = 2;
+		trits[1] = (C >> 4) & 1;
+		trits[0] = (((C >> 3) & 1) << 1) | ((C >> 2) & 1 & ~(C >> 3));
+	}
+	else if (((C >> 2) & 3) == 3)
+	{
+		trits[2] = 2;
+		trits[1] = 2;
+		trits[0] = C & 3;
+	}
+	else
+	{
+		trits[2] = (C >> 4) & 1;
+		trits[1] = (C >> 2) & 3;
+		trits[0] = (C & 2) | (C & 1 & ~(C >> 1));
+	}
+}
+
+static void decode_quints(uint32_t Q, uint32_t quints[3])
+{
+	if (((Q >> 1) & 3) == 3 && ((Q >> 5) & 3) == 0)
+	{
+		uint32_t not_q0 = ~Q & 1;
+		quints[2] = ((Q & 1) << 2) | (((Q >> 4) & not_q0) << 1) | ((Q >> 3) & not_q0);
+		quints[1] = 4;
+		quints[0] = 4;
+		return;
+	}
+
+	uint32_t C;
+	if (((Q >> 1) & 3) == 3)
+	{
+		quints[2] = 4;
+		C = (((Q >> 3) & 3) << 3) | ((~Q >> 5) & 3) << 1 | (Q & 1);
+	}
+	else
+	{
+		quints[2] = (Q >> 5) & 3;
+		C = Q & 0x1F;
+	}
+
+	if ((C & 7) == 5)
+	{
+		quints[1] = 4;
+		quints[0] = (C >> 3) & 3;
+	}
+	else
+	{
+		quints[1] = (C >> 3) & 3;
+		quints[0] = C & 7;
+	}
+}
+
+// Decodes count values of integer sequence. Every value is stored as trit or quint above its bits
+static void decode_ise(const uint8_t* block, uint32_t position, uint32_t count, const QuantMode& mode, uint8_t* values)
+{
+	uint32_t end = position + ise_length(count, mode);
+
+	if (mode.trits)
+	{
+		// Bits of packed trits after each of 5 values
+		static const uint8_t T_Bits[5] = { 2, 2, 1, 2, 1 };
+		for (uint32_t i = 0; count > i; i += 5)
+		{
+			uint32_t bits[5];
+			uint32_t T = 0;
+			for (uint32_t j = 0, shift = 0; 5 > j; shift += T_Bits[j], j++)
+			{
+				bits[j] = read_bits(block, position, end, mode.bits);
+				T |= read_bits(block, position, end, T_Bits[j]) << shift;
+			}
+
+			uint32_t trits[5];
+			decode_trits(T, trits);
+			for (uint32_t j = 0; 5 > j && count > i + j; j++)
+			{
+				values[i + j] = (uint8_t)((trits[j] << mode.bits) | bits[j]);
+			}
+		}
+	}
+	else if (mode.quints)
+	{
+		// Bits of packed quints after each of 3 values
+		static const uint8_t Q_Bits[3] = { 3, 2, 2 };
+		for (uint32_t i = 0; count > i; i += 3)
+		{
+			uint32_t bits[3];
+			uint32_t Q = 0;
+			for (uint32_t j = 0, shift = 0; 3 > j; shift += Q_Bits[j], j++)
+			{
+				bits[j] = read_bits(block, position, end, mode.bits);
+				Q |= read_bits(block, position, end, Q_Bits[j]) << shift;
+			}
+
+			uint32_t quints[3];
+			decode_quints(Q, quints);
+			for (uint32_t j = 0; 3 > j && count > i + j; j++)
+			{
+				values[i + j] = (uint8_t)((quints[j] << mode.bits) | bits[j]);
+			}
+		}
+	}
+	else
+	{
+		for (uint32_t i = 0; count > i; i++)
+		{
+			values[i] = (uint8_t)read_bits(block, position, end, mode.bits);
+		}
+	}
+}
+
+// Repeats bits of value until it has length bits
+static uint32_t replicate_bits(uint32_t value, uint32_t bits, uint32_t length)
+{
+	uint32_t result = 0;
+	for (int32_t shift = (int32_t)length - (int32_t)bits; shift > -(int32_t)bits; shift -= bits)
+	{
+		result |= shift >= 0 ? value << shift : value >> -shift;
+	}
+
+	return result;
+}
+
+// Unquantizes trit or quint value with at least one bit. Inverted top bit mirrors value
+static uint32_t unquantize_tq(uint32_t value, const QuantMode& mode, const uint16_t* B_masks, uint32_t C, uint32_t top_bit)
+{
+	uint32_t bits = value & ((1u << mode.bits) - 1);
+	uint32_t D = value >> mode.bits;
+
+	uint32_t A = (bits & 1) ? (top_bit << 2) - 1 : 0;
+	uint32_t B = 0;
+	for (uint32_t i = 1; mode.bits > i; i++)
+	{
+		if ((bits >> i) & 1) B |= B_masks[i - 1];
+	}
+
+	uint32_t T = (D * C + B) ^ A;
+	return (A & top_bit) | (T >> 2);
+}
+
+static uint8_t unquantize_color(uint8_t value, const QuantMode& mode)
+{
+	if (mode.trits) return (uint8_t)unquantize_tq(value, mode, Color_Trit_B[mode.bits], Color_Trit_C[mode.bits], 0x80);
+	if (mode.quints) return (uint8_t)unquantize_tq(value, mode, Color_Quint_B[mode.bits], Color_Quint_C[mode.bits], 0x80);
+	return (uint8_t)replicate_bits(value, mode.bits, 8);
+}
+
+// Weight in range [0, 64]
+static uint8_t unquantize_weight(uint8_t value, const QuantMode& mode)
+{
+	uint32_t result;
+	if (mode.bits == 0)
+	{
+		static const uint8_t Trit_Weights[3] = { 0, 32, 63 };
+		static const uint8_t Quint_Weights[5] = { 0, 16, 32, 47, 63 };
+		result = mode.trits ? Trit_Weights[value] : Quint_Weights[value];
+	}
+	else if (mode.trits)
+	{
+		result = unquantize_tq(value, mode, Weight_Trit_B[mode.bits], Weight_Trit_C[mode.bits], 0x20);
+	}
+	else if (mode.quints)
+	{
+		result = unquantize_tq(value, mode, Weight_Quint_B[mode.bits], Weight_Quint_C[mode.bits], 0x20);
+	}
+	else
+	{
+		result = replicate_bits(value, mode.bits, 6);
+	}
+
+	return (uint8_t)(result > 32 ? result + 1 : result);
+}
+
+// Reads size of weight grid, dual plane flag and weight quantization from 11 bits of block mode. Returns false for reserved modes
+static bool decode_block_mode(uint32_t mode, uint32_t& weights_x, uint32_t& weights_y, bool& is_dual_plane, uint32_t& weight_quant)
+{
+	uint32_t R = (mode >> 4) & 1;
+	uint32_t H = (mode >> 9) & 1;
+	uint32_t D = (mode >> 10) & 1;
+	uint32_t A = (mode >> 5) & 3;
+
+	if ((mode & 3) != 0)
+	{
+		R |= (mode & 3) << 1;
+		uint32_t B = (mode >> 7) & 3;
+		switch ((mode >> 2) & 3)
+		{
+		case 0: weights_x = B + 4; weights_y = A + 2; break;
+		case 1: weights_x = B + 8; weights_y = A + 2; break;
+		case 2: weights_x = A + 2; weights_y = B + 8; break;
+		default:
+			B &= 1;
+			if (mode & 0x100)
+			{
+				weights_x = B + 2;
+				weights_y = A + 2;
+			}
+			else
+			{
+				weights_x = A + 2;
+				weights_y = B + 6;
+			}
+			break;
+		}
+	}
+	else
+	{
+		R |= ((mode >> 2) & 3) << 1;
+		if (((mode >> 2) & 3) == 0) return false;
+
+		uint32_t B = (mode >> 9) & 3;
+		switch ((mode >> 7) & 3)
+		{
+		case 0: weights_x = 12; weights_y = A + 2; break;
+		case 1: weights_x = A + 2; weights_y = 12; break;
+		case 2: weights_x = A + 6; weights_y = B + 6; D = 0; H = 0; break;
+		default:
+			if (A == 0) { weights_x = 6; weights_y = 10; }
+			else if (A == 1) { weights_x = 10; weights_y = 6; }
+			else return false;
+			break;
+		}
+	}
+
+	is_dual_plane = D != 0;
+	weight_quant = R - 2 + 6 * H;
+	return true;
+}
+
+// Texel partition of block with several partitions
+static uint32_t select_partition(uint32_t seed, uint32_t x, uint32_t y, uint32_t partitions_count, bool is_small_block)
+{
+	if (is_small_block)
+	{
+		x <<= 1;
+		y <<= 1;
+	}
+
+	seed += (partitions_count - 1) * 1024;
+
+	uint32_t rnum = seed;
+	rnum ^= rnum >> 15;
+	rnum -= rnum << 17;
+	rnum += rnum << 7;
+	rnum += rnum << 4;
+	rnum ^= rnum >> 5;
+	rnum += rnum << 16;
+	rnum ^= rnum >> 7;
+	rnum ^= rnum >> 3;
+	rnum ^= rnum << 6;
+	rnum ^= rnum >> 17;
+
+	uint32_t seeds[8];
+	for (uint32_t i = 0; 8 > i; i++)
+	{
+		uint32_t value = (rnum >> (i * 4)) & 0xF;
+		seeds[i] = value * value;
+	}
+
+	uint32_t shift1, shift2;
+	if (seed & 1)
+	{
+		shift1 = (seed & 2) ? 4 : 5;
+		shift2 = partitions_count == 3 ? 6 : 5;
+	}
+	else
+	{
+		shift1 = partitions_count == 3 ? 6 : 5;
+		shift2 = (seed & 2) ? 4 : 5;
+	}
+
+	for (uint32_t i = 0; 8 > i; i += 2)
+	{
+		seeds[i] >>= shift1;
+		seeds[i + 1] >>= shift2;
+	}
+
+	uint32_t a = (seeds[0] * x + seeds[1] * y + (rnum >> 14)) & 0x3F;
+	uint32_t b = (seeds[2] * x + seeds[3] * y + (rnum >> 10)) & 0x3F;
+	uint32_t c = partitions_count >= 3 ? (seeds[4] * x + seeds[5] * y + (rnum >> 6)) & 0x3F : 0;
+	uint32_t d = partitions_count >= 4 ? (seeds[6] * x + seeds[7] * y + (rnum >> 2)) & 0x3F : 0;
+
+	if (a >= b && a >= c && a >= d) return 0;
+	if (b >= c && b >= d) return 1;
+	if (c >= d) return 2;
+	return 3;
+}
+
+static void bit_transfer_signed(int32_t& a, int32_t& b)
+{
+	b >>= 1;
+	b |= a & 0x80;
+	a >>= 1;
+	a &= 0x3F;
+	if (a & 0x20) a -= 0x40;
+}
+
+static void blue_contract(int32_t color[4])
+{
+	color[0] = (color[0] + color[2]) >> 1;
+	color[1] = (color[1] + color[2]) >> 1;
+}
+
+// Decodes RGBA endpoints of LDR color endpoint mode. Returns false for HDR modes
+static bool decode_endpoints(uint32_t format, const uint8_t* values, int32_t endpoint0[4], int32_t endpoint1[4])
+{
+	int32_t v[8];
+	for (uint32_t i = 0; ((format >> 2) + 1) * 2 > i; i++)
+	{
+		v[i] = values[i];
+	}
+
+	switch (format)
+	{
+	// Luminance
+	case 0:
+		endpoint0[0] = endpoint0[1] = endpoint0[2] = v[0]; endpoint0[3] = 0xFF;
+		endpoint1[0] = endpoint1[1] = endpoint1[2] = v[1]; endpoint1[3] = 0xFF;
+		break;
+	// Luminance, base and offset
+	case 1:
+	{
+		int32_t l0 = (v[0] >> 2) | (v[1] & 0xC0);
+		int32_t l1 = l0 + (v[1] & 0x3F);
+		endpoint0[0] = endpoint0[1] = endpoint0[2] = l0; endpoint0[3] = 0xFF;
+		endpoint1[0] = endpoint1[1] = endpoint1[2] = l1; endpoint1[3] = 0xFF;
+		break;
+	}
+	// Luminance and alpha
+	case 4:
+		endpoint0[0] = endpoint0[1] = endpoint0[2] = v[0]; endpoint0[3] = v[2];
+		endpoint1[0] = endpoint1[1] = endpoint1[2] = v[1]; endpoint1[3] = v[3];
+		break;
+	// Luminance and alpha, base and offset
+	case 5:
+		bit_transfer_signed(v[1], v[0]);
+		bit_transfer_signed(v[3], v[2]);
+		endpoint0[0] = endpoint0[1] = endpoint0[2] = v[0]; endpoint0[3] = v[2];
+		endpoint1[0] = endpoint1[1] = endpoint1[2] = v[0] + v[1]; endpoint1[3] = v[2] + v[3];
+		break;
+	// RGB and scale, with two alpha values in mode 10
+	case 6:
+	case 10:
+		for (uint8_t channel = 0; 3 > channel; channel++)
+		{
+			endpoint0[channel] = (v[channel] * v[3]) >> 8;
+			endpoint1[channel] = v[channel];
+		}
+		endpoint0[3] = format == 10 ? v[4] : 0xFF;
+		endpoint1[3] = format == 10 ? v[5] : 0xFF;
+		break;
+	// RGB and RGBA
+	case 8:
+	case 12:
+	{
+		bool has_alpha = format == 12;
+		for (uint8_t channel = 0; 4 > channel; channel++)
+		{
+			endpoint0[channel] = channel == 3 && !has_alpha ? 0xFF : v[channel * 2];
+			endpoint1[channel] = channel == 3 && !has_alpha ? 0xFF : v[channel * 2 + 1];
+		}
+
+		if (v[1] + v[3] + v[5] < v[0] + v[2] + v[4])
+		{
+			std::swap_ranges(endpoint0, endpoint0 + 4, endpoint1);
+			blue_contract(endpoint0);
+			blue_contract(endpoint1);
+		}
+		break;
+	}
+	// RGB and RGBA, base and offset
+	case 9:
+	case 13:
+	{
+		bool has_alpha = format == 13;
+		for (uint8_t channel = 0; 4 > channel; channel++)
+		{
+			if (channel == 3 && !has_alpha)
+			{
+				endpoint0[channel] = endpoint1[channel] = 0xFF;
+				continue;
+			}
+
+			bit_transfer_signed(v[channel * 2 + 1], v[channel * 2]);
+			endpoint0[channel] = v[channel * 2];
+			endpoint1[channel] = v[channel * 2] + v[channel * 2 + 1];
+		}
+
+		if (v[1] + v[3] + v[5] < 0)
+		{
+			std::swap_ranges(endpoint0, endpoint0 + 4, endpoint1);
+			blue_contract(endpoint0);
+			blue_contract(endpoint1);
+		}
+		break;
+	}
+	default:
+		return false;
+	}
+
+	for (uint8_t channel = 0; 4 > channel; channel++)
+	{
+		endpoint0[channel] = std::min(std::max(endpoint0[channel], 0), 0xFF);
+		endpoint1[channel] = std::min(std::max(endpoint1[channel], 0), 0xFF);
+	}
+
+	return true;
+}
+#pragma endregion
+
+// Average color of block computed from its endpoints and mean of its weight grid, texels are not decoded.
+// Returns false for blocks with HDR endpoints
+static bool block_endpoints_average_color(const uint8_t* block, uint8_t blocks_x, uint8_t blocks_y, uint8_t* pixel)
+{
+	uint32_t position = 0;
+	uint32_t weights_x, weights_y, weight_quant;
+	bool is_dual_plane;
+	if (!decode_block_mode(read_bits(block, position, 128, 11), weights_x, weights_y, is_dual_plane, weight_quant) ||
+		weights_x > blocks_x || weights_y > blocks_y)
+	{
+		error_color(pixel);
+		return true;
+	}
+
+	uint32_t partitions_count = read_bits(block, position, 128, 2) + 1;
+	uint32_t weights_count = weights_x * weights_y * (is_dual_plane ? 2 : 1);
+	uint32_t weight_bits = ise_length(weights_count, Quant_Modes[weight_quant]);
+	if ((partitions_count == 4 && is_dual_plane) || weights_count > 64 || 24 > weight_bits || weight_bits > 96)
+	{
+		error_color(pixel);
+		return true;
+	}
+
+	uint32_t below_weights = 128 - weight_bits;
+	uint32_t formats[4];
+	uint32_t partition_index = 0;
+	if (partitions_count == 1)
+	{
+		formats[0] = read_bits(block, position, 128, 4);
+	}
+	else
+	{
+		partition_index = read_bits(block, position, 128, 10);
+		uint32_t format = read_bits(block, position, 128, 6);
+		if ((format & 3) == 0)
+		{
+			for (uint32_t i = 0; partitions_count > i; i++)
+			{
+				formats[i] = format >> 2;
+			}
+		}
+		else
+		{
+			// Formats of partitions have class offset and mode, remaining bits are stored below weights
+			uint32_t extra_bits = 3 * partitions_count - 4;
+			below_weights -= extra_bits;
+			uint32_t extra_position = below_weights;
+			format |= read_bits(block, extra_position, 128, extra_bits) << 6;
+
+			uint32_t base_class = (format & 3) - 1;
+			for (uint32_t i = 0; partitions_count > i; i++)
+			{
+				uint32_t format_class = base_class + ((format >> (2 + i)) & 1);
+				uint32_t format_mode = (format >> (2 + partitions_count + i * 2)) & 3;
+				formats[i] = (format_class << 2) | format_mode;
+			}
+		}
+	}
+
+	uint32_t second_plane_channel = 4;
+	if (is_dual_plane)
+	{
+		below_weights -= 2;
+		uint32_t channel_position = below_weights;
+		second_plane_channel = read_bits(block, channel_position, 128, 2);
+	}
+
+	uint32_t color_values_count = 0;
+	for (uint32_t i = 0; partitions_count > i; i++)
+	{
+		color_values_count += ((formats[i] >> 2) + 1) * 2;
+	}
+
+	// Color values use highest quantization that fits between header and weights
+	uint32_t color_bits = below_weights > position ? below_weights - position : 0;
+	uint8_t color_quant = Quant_Modes_Count - 1;
+	while (color_quant > 0 && ise_length(color_values_count, Quant_Modes[color_quant]) > color_bits)
+	{
+		color_quant--;
+	}
+
+	if (color_values_count > 18 || Min_Color_Quant > color_quant)
+	{
+		error_color(pixel);
+		return true;
+	}
+
+	uint8_t color_values[18];
+	decode_ise(block, position, color_values_count, Quant_Modes[color_quant], color_values);
+
+	int32_t endpoints[4][2][4];
+	for (uint32_t i = 0, offset = 0; partitions_count > i; offset += ((formats[i] >> 2) + 1) * 2, i++)
+	{
+		for (uint32_t j = 0; ((formats[i] >> 2) + 1) * 2 > j; j++)
+		{
+			color_values[offset + j] = unquantize_color(color_values[offset + j], Quant_Modes[color_quant]);
+		}
+
+		if (!decode_endpoints(formats[i], color_values + offset, endpoints[i][0], endpoints[i][1]))
+		{
+			return false;
+		}
+	}
+
+	// Weights are stored from the end of block with reversed bits
+	uint8_t reversed_block[16];
+	for (uint8_t i = 0; 16 > i; i++)
+	{
+		uint8_t value = block[15 - i];
+		value = (uint8_t)(((value * 0x0802u & 0x22110u) | (value * 0x8020u & 0x88440u)) * 0x10101u >> 16);
+		reversed_block[i] = value;
+	}
+
+	uint8_t weights[64];
+	decode_ise(reversed_block, 0, weights_count, Quant_Modes[weight_quant], weights);
+
+	// Planes are interleaved in grid
+	uint32_t weight_sums[2] = { 0, 0 };
+	for (uint32_t i = 0; weights_count > i; i++)
+	{
+		weight_sums[is_dual_plane ? i & 1 : 0] += unquantize_weight(weights[i], Quant_Modes[weight_quant]);
+	}
+
+	uint32_t grid_size = weights_x * weights_y;
+	uint32_t texels_count = (uint32_t)blocks_x * blocks_y;
+	uint32_t partition_texels[4] = { texels_count, 0, 0, 0 };
+	if (partitions_count > 1)
+	{
+		partition_texels[0] = 0;
+		for (uint32_t y = 0; blocks_y > y; y++)
+		{
+			for (uint32_t x = 0; blocks_x > x; x++)
+			{
+				partition_texels[select_partition(partition_index, x, y, partitions_count, 31 > texels_count)]++;
+			}
+		}
+	}
+
+	for (uint8_t channel = 0; 4 > channel; channel++)
+	{
+		uint32_t weight_sum = weight_sums[channel == second_plane_channel ? 1 : 0];
+
+		// Sum of texels is sum of partition endpoints interpolated by mean weight, multiplied by texel count
+		uint64_t color = 0;
+		for (uint32_t partition = 0; partitions_count > partition; partition++)
+		{
+			int64_t endpoint0 = endpoints[partition][0][channel];
+			int64_t endpoint1 = endpoints[partition][1][channel];
+			color += (uint64_t)((endpoint0 * (64 * grid_size) + (endpoint1 - endpoint0) * weight_sum) * partition_texels[partition]);
+		}
+
+		uint64_t divisor = (uint64_t)64 * grid_size * texels_count;
+		pixel[channel] = (uint8_t)((color + divisor / 2) / divisor);
+	}
+
+	return true;
+}
+
+// Average color of block. Weights are averaged over weight grid, so partitioned blocks get approximate color
+static void block_average_color(astcenc_context* context, const uint8_t* block, uint8_t blocks_x, uint8_t blocks_y, uint8_t* pixel)
+{
+	if (is_void_extent_block(block))
+	{
+		bool is_hdr = (block[1] & 0x02) != 0;
+		for (uint8_t channel = 0; 4 > channel; channel++)
+		{
+			uint16_t value = block[8 + channel * 2] | (block[9 + channel * 2] << 8);
+			pixel[channel] = float_to_unorm8(is_hdr ? half_to_float(value) : value / 65535.0f);
+		}
+
+		return;
+	}
+
+	// HDR endpoints are rare, their decoding is left to astcenc
+	if (!block_endpoints_average_color(block, blocks_x, blocks_y, pixel))
+	{
+		block_info_average_color(context, block, pixel);
+	}
+}
+
 namespace sc
 {
 	namespace Decompressor
@@ -38,6 +787,20 @@ namespace sc
 			buffer.seek(3, Seek::Add);
 		};
 
+		void Astc::read_thumbnail(Stream& input, Stream& output, uint16_t& width, uint16_t& height, Props props)
+		{
+			uint16_t image_width;
+			uint16_t image_height;
+			read_header(input, image_width, image_height, props.blocks_x, props.blocks_y);
+
+			// Blocks follow header and are read in place
+			Astc context(props);
+			context.decompress_thumbnail(image_width, image_height, input, output);
+
+			width = (image_width + props.blocks_x - 1) / props.blocks_x;
+			height = (image_height + props.blocks_y - 1) / props.blocks_y;
+		}
+
 		Astc::Astc(Props& props)
 		{
 			astcenc_error status;
@@ -52,13 +815,21 @@ namespace sc
 
 			if (status != ASTCENC_SUCCESS) throw AstcGeneralException(status);
 
-			status = astcenc_context_alloc(&config, props.threads_count, &m_context);
+			m_blocks_x = props.blocks_x;
+			m_blocks_y = props.blocks_y;
+
+			m_threads_count = props.threads_count == 0 ? 1 : props.threads_count;
+			status = astcenc_context_alloc(&config, m_threads_count, &m_context);
 
 			if (status != ASTCENC_SUCCESS) throw AstcGeneralException(status);
+
+			m_pool = new ThreadPool(m_threads_count);
 		}
 
 		Astc::~Astc()
 		{
+			delete m_pool;
+
 			if (m_context)
 			{
 				astcenc_context_free(m_context);
@@ -82,18 +853,254 @@ namespace sc
 			uint8_t* input_data = (uint8_t*)input.data() + input.position();
 			size_t input_data_length = input.length() - input.position();
 
-			astcenc_error status = astcenc_decompress_image(m_context, input_data, input_data_length, &decoder_image, &swizzle, 0);
+			astcenc_error status = (astcenc_error)decompress_blocks(input_data, input_data_length, decoder_image, swizzle, m_threads_count);
 			if (status != ASTCENC_SUCCESS)
 			{
 				free(data);
 				throw AstcGeneralException(status);
+			}
+
+			output.write(data, data_size);
+			free(data);
+		}
+
+		void Astc::decompress_region(
+			uint16_t width, uint16_t height, Image::BasePixelType type, Stream& input,
+			uint16_t x, uint16_t y, uint16_t region_width, uint16_t region_height,
+			uint8_t* destination, size_t destination_stride
+		)
+		{
+			// Size of ASTC block in bytes and of decoded pixel
+			const size_t block_size = 16;
+			const size_t pixel_size = 4;
+
+			if (region_width == 0 || region_height == 0)
+			{
 				return;
 			}
 
+			if ((uint32_t)x + region_width > width || (uint32_t)y + region_height > height)
+			{
+				throw AstcGeneralException(ASTCENC_ERR_BAD_PARAM);
+			}
+
+			if (destination_stride == 0)
+			{
+				destination_stride = region_width * pixel_size;
+			}
+
+			uint32_t xblocks = (width + m_blocks_x - 1) / m_blocks_x;
+			uint32_t yblocks = (height + m_blocks_y - 1) / m_blocks_y;
+
+			const uint8_t* input_data = (const uint8_t*)input.data() + input.position();
+			size_t input_data_length = input.length() - input.position();
+			if (input_data_length < (size_t)xblocks * yblocks * block_size)
+			{
+				throw AstcGeneralException(ASTCENC_ERR_BAD_PARAM);
+			}
+
+			// Blocks that cover rectangle
+			uint32_t first_column = x / m_blocks_x;
+			uint32_t columns_count = (x + region_width - 1) / m_blocks_x - first_column + 1;
+			uint32_t first_row = y / m_blocks_y;
+			uint32_t rows_count = (y + region_height - 1) / m_blocks_y - first_row + 1;
+
+			// Blocks are gathered to a smaller image that contains only covering rows and columns
+			size_t row_length = columns_count * block_size;
+			uint8_t* blocks = memalloc(rows_count * row_length);
+			for (uint32_t row = 0; rows_count > row; row++)
+			{
+				memcpy(
+					blocks + row * row_length,
+					input_data + (((size_t)first_row + row) * xblocks + first_column) * block_size,
+					row_length
+				);
+			}
+
+			uint32_t sub_x = first_column * m_blocks_x;
+			uint32_t sub_y = first_row * m_blocks_y;
+			uint32_t sub_width = std::min<uint32_t>(columns_count * m_blocks_x, width - sub_x);
+			uint32_t sub_height = std::min<uint32_t>(rows_count * m_blocks_y, height - sub_y);
+
+			uint8_t* data = memalloc((size_t)sub_width * sub_height * pixel_size);
+
+			astcenc_image decoder_image;
+			decoder_image.dim_x = sub_width;
+			decoder_image.dim_y = sub_height;
+			decoder_image.dim_z = 1;
+			decoder_image.data = reinterpret_cast<void**>(&data);
+			decoder_image.data_type = ASTCENC_TYPE_U8;
+
+			astcenc_swizzle swizzle = astc::get_swizzle(type);
+
+			// Small regions are not worth to wake up all threads
+			const uint32_t blocks_per_thread = 1024;
+			uint32_t threads_count = std::min(m_threads_count, columns_count * rows_count / blocks_per_thread + 1);
+
+			astcenc_error status = (astcenc_error)decompress_blocks(blocks, rows_count * row_length, decoder_image, swizzle, threads_count);
+			free(blocks);
+
+			if (status != ASTCENC_SUCCESS)
+			{
+				free(data);
+				throw AstcGeneralException(status);
+			}
+
+			for (uint32_t row = 0; region_height > row; row++)
+			{
+				memcpy(
+					destination + row * destination_stride,
+					data + (((size_t)y - sub_y + row) * sub_width + (x - sub_x)) * pixel_size,
+					region_width * pixel_size
+				);
+			}
+
+			free(data);
+		}
+
+		void Astc::decompress_thumbnail(uint16_t width, uint16_t height, Stream& input, Stream& output)
+		{
+			const size_t block_size = 16;
+			const size_t pixel_size = 4;
+
+			uint32_t xblocks = (width + m_blocks_x - 1) / m_blocks_x;
+			uint32_t yblocks = (height + m_blocks_y - 1) / m_blocks_y;
+
+			const uint8_t* input_data = (const uint8_t*)input.data() + input.position();
+			size_t input_data_length = input.length() - input.position();
+			if (input_data_length < (size_t)xblocks * yblocks * block_size)
+			{
+				throw AstcGeneralException(ASTCENC_ERR_BAD_PARAM);
+			}
+
+			size_t data_size = (size_t)xblocks * yblocks * pixel_size;
+			if (data_size == 0)
+			{
+				return;
+			}
+
+			uint8_t* data = memalloc(data_size);
+
+			// Blocks are read without changes of context, so rows of blocks are shared between threads
+			uint32_t threads_count = std::min(m_threads_count, yblocks);
+			m_pool->run(threads_count, [&](uint32_t thread_index)
+				{
+					for (uint32_t row = thread_index; yblocks > row; row += threads_count)
+					{
+						for (uint32_t column = 0; xblocks > column; column++)
+						{
+							size_t index = (size_t)row * xblocks + column;
+							block_average_color(m_context, input_data + index * block_size, m_blocks_x, m_blocks_y, data + index * pixel_size);
+						}
+					}
+				}
+			);
+
 			output.write(data, data_size);
+			free(data);
+		}
+
+		void Astc::decompress_image_striped(
+			uint16_t width, uint16_t height, Image::BasePixelType type,
+			Stream& input, const RowConsumer& consumer,
+			uint32_t band_block_rows
+		)
+		{
+			const size_t block_size = 16;
+			const size_t pixel_size = 4;
+
+			if (band_block_rows == 0) band_block_rows = 1;
+
+			astcenc_swizzle swizzle = astc::get_swizzle(type);
+
+			uint32_t xblocks = (width + m_blocks_x - 1) / m_blocks_x;
+			uint32_t yblocks = (height + m_blocks_y - 1) / m_blocks_y;
+			if (xblocks == 0 || yblocks == 0) return;
+
+			band_block_rows = std::min(band_block_rows, yblocks);
+
+			uint8_t* blocks = memalloc((size_t)xblocks * band_block_rows * block_size);
+			uint8_t* pixels = memalloc((size_t)width * band_block_rows * m_blocks_y * pixel_size);
+
+			try
+			{
+				for (uint32_t row = 0; yblocks > row; row += band_block_rows)
+				{
+					uint32_t rows_count = std::min(band_block_rows, yblocks - row);
+					uint32_t first_line = row * m_blocks_y;
+					uint32_t lines_count = std::min<uint32_t>(rows_count * m_blocks_y, height - first_line);
+
+					size_t band_size = (size_t)xblocks * rows_count * block_size;
+					if (input.read(blocks, band_size) != band_size)
+					{
+						throw AstcGeneralException(ASTCENC_ERR_BAD_PARAM);
+					}
+
+					astcenc_image band;
+					band.dim_x = width;
+					band.dim_y = lines_count;
+					band.dim_z = 1;
+					band.data = reinterpret_cast<void**>(&pixels);
+					band.data_type = ASTCENC_TYPE_U8;
 
+					astcenc_error status = (astcenc_error)decompress_blocks(blocks, band_size, band, swizzle, m_threads_count);
+					if (status != ASTCENC_SUCCESS)
+					{
+						throw AstcGeneralException(status);
+					}
+
+					consumer(first_line, lines_count, pixels);
+				}
+			}
+			catch (...)
+			{
+				free(blocks);
+				free(pixels);
+				throw;
+			}
+
+			free(blocks);
+			free(pixels);
+		}
+
+		void Astc::decompress_image_striped(
+			uint16_t width, uint16_t height, Image::BasePixelType type,
+			Stream& input, Stream& output,
+			uint32_t band_block_rows
+		)
+		{
+			const size_t pixel_size = 4;
+
+			decompress_image_striped(width, height, type, input,
+				[&output, width](uint32_t, uint32_t rows_count, const uint8_t* rows)
+				{
+					output.write(rows, (size_t)width * rows_count * pixel_size);
+				},
+				band_block_rows
+			);
+		}
+
+		int Astc::decompress_blocks(const uint8_t* data, size_t data_size, astcenc_image& image, astcenc_swizzle& swizzle, uint32_t threads_count)
+		{
+			std::vector<astcenc_error> statuses(threads_count, ASTCENC_SUCCESS);
+			m_pool->run(threads_count, [&](uint32_t thread_index)
+				{
+					statuses[thread_index] = astcenc_decompress_image(m_context, data, data_size, &image, &swizzle, thread_index);
+				}
+			);
+
+			// Context must be reset before next image
 			astcenc_decompress_reset(m_context);
-			free(data);
+
+			for (astcenc_error status : statuses)
+			{
+				if (status != ASTCENC_SUCCESS)
+				{
+					return status;
+				}
+			}
+
+			return ASTCENC_SUCCESS;
 		}
 	}
 }
\ No newline at end of file
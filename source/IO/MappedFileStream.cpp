@@ -0,0 +1,167 @@
+#include "SupercellCompression/MappedFileStream.h"
+
+#include "SupercellCompression/exception/MappedFileStream.h"
+
+#if defined _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sc
+{
+#if defined _WIN32
+	MappedFile::MappedFile(const std::filesystem::path& path, size_t length, bool writable)
+	{
+		HANDLE file = CreateFileW(
+			path.c_str(),
+			writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+			FILE_SHARE_READ,
+			nullptr,
+			writable ? CREATE_ALWAYS : OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL,
+			nullptr
+		);
+
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			throw MappedFileOpenException();
+		}
+		m_file = file;
+
+		if (writable)
+		{
+			LARGE_INTEGER file_length;
+			file_length.QuadPart = static_cast<LONGLONG>(length);
+			if (!SetFilePointerEx(file, file_length, nullptr, FILE_BEGIN) || !SetEndOfFile(file))
+			{
+				CloseHandle(file);
+				throw MappedFileResizeException();
+			}
+		}
+		else
+		{
+			LARGE_INTEGER file_length;
+			GetFileSizeEx(file, &file_length);
+			length = static_cast<size_t>(file_length.QuadPart);
+		}
+
+		// Empty files can not be mapped
+		if (length == 0)
+		{
+			return;
+		}
+
+		m_mapping = CreateFileMappingW(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+		if (!m_mapping)
+		{
+			CloseHandle(file);
+			throw MappedFileMapException();
+		}
+
+		m_mapped_data = (uint8_t*)MapViewOfFile(m_mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, length);
+		if (!m_mapped_data)
+		{
+			CloseHandle(m_mapping);
+			CloseHandle(file);
+			throw MappedFileMapException();
+		}
+
+		m_mapped_length = length;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_mapped_data)
+		{
+			UnmapViewOfFile(m_mapped_data);
+		}
+
+		if (m_mapping)
+		{
+			CloseHandle(m_mapping);
+		}
+
+		// File can be resized only after its mapping is closed
+		if (m_final_length != SIZE_MAX)
+		{
+			LARGE_INTEGER file_length;
+			file_length.QuadPart = static_cast<LONGLONG>(m_final_length);
+			SetFilePointerEx(m_file, file_length, nullptr, FILE_BEGIN);
+			SetEndOfFile(m_file);
+		}
+
+		CloseHandle(m_file);
+	}
+#else
+	MappedFile::MappedFile(const std::filesystem::path& path, size_t length, bool writable)
+	{
+		m_file = writable ? open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) : open(path.c_str(), O_RDONLY);
+		if (m_file < 0)
+		{
+			throw MappedFileOpenException();
+		}
+
+		if (writable)
+		{
+			if (ftruncate(m_file, static_cast<off_t>(length)) != 0)
+			{
+				close(m_file);
+				throw MappedFileResizeException();
+			}
+		}
+		else
+		{
+			struct stat file_stat;
+			if (fstat(m_file, &file_stat) != 0)
+			{
+				close(m_file);
+				throw MappedFileOpenException();
+			}
+
+			length = static_cast<size_t>(file_stat.st_size);
+		}
+
+		// Empty files can not be mapped
+		if (length == 0)
+		{
+			return;
+		}
+
+		void* data = mmap(nullptr, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_file, 0);
+		if (data == MAP_FAILED)
+		{
+			close(m_file);
+			throw MappedFileMapException();
+		}
+
+		m_mapped_data = (uint8_t*)data;
+		m_mapped_length = length;
+
+		// Decompressors read input from begin to end, so kernel can read ahead more aggressively
+		if (!writable)
+		{
+			madvise(data, length, MADV_SEQUENTIAL);
+		}
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_mapped_data)
+		{
+			munmap(m_mapped_data, m_mapped_length);
+		}
+
+		if (m_final_length != SIZE_MAX)
+		{
+			ftruncate(m_file, static_cast<off_t>(m_final_length));
+		}
+
+		close(m_file);
+	}
+#endif
+}
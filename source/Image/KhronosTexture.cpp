@@ -157,6 +157,39 @@ namespace sc
 		}
 	}
 
+	void KhronosTexture::decompress_thumbnail(Stream& output, uint16_t& width, uint16_t& height, uint32_t level_index)
+	{
+		width = 0;
+		height = 0;
+
+		if (compression_type() != KhronosTextureCompression::ASTC) return;
+
+		if (level_index >= m_levels.size()) level_index = static_cast<uint32_t>(m_levels.size()) - 1;
+		BufferStream* buffer = m_levels[level_index];
+		if (buffer == nullptr) return;
+
+		uint16_t level_width = m_width / (uint16_t)pow(2, level_index);
+		uint16_t level_height = m_height / (uint16_t)pow(2, level_index);
+
+		uint8_t blocks_x;
+		uint8_t blocks_y;
+		uint8_t blocks_z;
+		get_astc_blocks(m_internal_format, blocks_x, blocks_y, blocks_z);
+
+		Decompressor::Astc::Props props;
+		props.blocks_x = blocks_x;
+		props.blocks_y = blocks_y;
+		props.profile = colorspace() == ColorSpace::Linear ? astc::Profile::PRF_LDR : astc::Profile::PRF_LDR_SRGB;
+
+		// Level data is read in place
+		buffer->seek(0);
+		Decompressor::Astc context(props);
+		context.decompress_thumbnail(level_width, level_height, *buffer, output);
+
+		width = (level_width + blocks_x - 1) / blocks_x;
+		height = (level_height + blocks_y - 1) / blocks_y;
+	}
+
 	void KhronosTexture::set_level_data(Stream& stream, Image::PixelDepth source_depth, uint32_t level_index)
 	{
 		// First, check if level index is ok
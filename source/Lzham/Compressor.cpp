@@ -62,7 +62,7 @@ namespace sc
 				if (input_buffer_offset == input_buffer_position)
 				{
 					input_buffer_position = static_cast<uint32_t>(min(Lzham::Stream_Size, remain_bytes));
-					if (input.read(m_input_buffer, input_buffer_position) != input_buffer_position)
+					if (read_input(input, m_input_buffer, input_buffer_position) != input_buffer_position)
 					{
 						throw LzhamCorruptedDecompressException();
 					}
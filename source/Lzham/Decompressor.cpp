@@ -15,18 +15,9 @@ namespace sc
 			struct_size = sizeof(lzham_decompress_params);
 		}
 
-		Lzham::Lzham(Props& props)
+		Lzham::Lzham(Props& props) : m_props(props)
 		{
-			m_state = lzham_decompress_init((lzham_decompress_params*)&props);
-			if (!m_state)
-			{
-				throw LzhamDecompressInitException();
-			}
-
 			m_unpacked_length = props.unpacked_length;
-
-			m_input_buffer = memalloc(Lzham::Stream_Size);
-			m_output_buffer = memalloc(Lzham::Stream_Size);
 		}
 
 		Lzham::~Lzham()
@@ -41,16 +32,44 @@ namespace sc
 				free(m_output_buffer);
 			}
 
-			lzham_decompress_deinit(m_state);
+			if (m_state)
+			{
+				lzham_decompress_deinit(m_state);
+			}
 		}
 
 		void Lzham::decompress_stream(Stream& input, Stream& output)
 		{
+			// Data that is cut by output limit is streamed, so only its beginning is decoded
+			uint8_t* destination = nullptr;
+			if (m_output_limit >= m_unpacked_length)
+			{
+				destination = reserve_output(output, m_unpacked_length, input.length() - input.position());
+			}
+
+			if (destination)
+			{
+				decompress_direct(input, output, destination);
+				return;
+			}
+
+			if (!m_state)
+			{
+				m_state = lzham_decompress_init((lzham_decompress_params*)&m_props);
+				if (!m_state)
+				{
+					throw LzhamDecompressInitException();
+				}
+			}
+
+			if (!m_input_buffer) m_input_buffer = memalloc(Lzham::Stream_Size);
+			if (!m_output_buffer) m_output_buffer = memalloc(Lzham::Stream_Size);
+
 			size_t remain_bytes = input.length() - input.position();
 
 			uint32_t buffer_size = 0, buffer_offset = 0;
 			lzham_decompress_status_t status;
-			while (true)
+			while (m_output_limit != 0)
 			{
 				if (buffer_offset == buffer_size)
 				{
@@ -75,7 +94,17 @@ namespace sc
 
 				if (output_bytes_length)
 				{
-					output.write(m_output_buffer, static_cast<uint32_t>(output_bytes_length));
+					if (output_bytes_length > m_output_limit)
+					{
+						output_bytes_length = m_output_limit;
+					}
+
+					write_output(output, m_output_buffer, output_bytes_length);
+
+					if (m_output_limit != SIZE_MAX)
+					{
+						m_output_limit -= output_bytes_length;
+					}
 
 					if (output_bytes_length > m_unpacked_length)
 					{
@@ -88,5 +117,48 @@ namespace sc
 					break;
 			}
 		}
+
+		void Lzham::decompress_direct(Stream& input, Stream& output, uint8_t* destination)
+		{
+			size_t remain_bytes = input.length() - input.position();
+
+			// Unbuffered decoder needs whole compressed data at once. Data in memory is used directly
+			const uint8_t* source = nullptr;
+			uint8_t* source_buffer = nullptr;
+			if (input.data() != nullptr)
+			{
+				source = (const uint8_t*)input.data() + input.position();
+				input.seek(remain_bytes, Seek::Add);
+			}
+			else
+			{
+				source_buffer = memalloc(remain_bytes ? remain_bytes : 1);
+				remain_bytes = input.read(source_buffer, remain_bytes);
+				source = source_buffer;
+			}
+
+			// Output memory holds whole data, so it is used as decoder dictionary and nothing is copied
+			Props props = m_props;
+			props.decompress_flags |= LZHAM_DECOMP_FLAG_OUTPUT_UNBUFFERED;
+
+			size_t out_length = m_unpacked_length;
+			lzham_uint32 adler32 = 0;
+			lzham_decompress_status_t status = lzham_decompress_memory(
+				(lzham_decompress_params*)&props, destination, &out_length, source, remain_bytes, &adler32
+			);
+
+			if (source_buffer)
+			{
+				free(source_buffer);
+			}
+
+			if (status != LZHAM_DECOMP_STATUS_SUCCESS || out_length != m_unpacked_length)
+			{
+				throw LzhamCorruptedDecompressException();
+			}
+
+			commit_output(output, destination, out_length);
+			m_unpacked_length = 0;
+		}
 	}
 }
\ No newline at end of file
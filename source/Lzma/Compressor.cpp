@@ -6,6 +6,8 @@
 #include "LzmaEnc.h"
 #include "SupercellCompression/exception/Lzma.h"
 
+#include <algorithm>
+
 namespace sc
 {
 	namespace lzma
@@ -27,6 +29,7 @@ struct CSeqInStreamWrap
 {
 	ISeqInStream vt;
 	sc::Stream* input;
+	const sc::Compressor::CompressionInterface::ChunkCallback* callback;
 };
 
 struct CSeqOutStreamWrap
@@ -41,6 +44,11 @@ static SRes LzmaStreamRead(const ISeqInStream* p, void* data, size_t* size)
 	size_t bufferReadSize = (*size < Stream_Size) ? *size : Stream_Size;
 	size_t readSize = wrap->input->read(data, bufferReadSize);
 
+	if (readSize && *wrap->callback)
+	{
+		(*wrap->callback)((const uint8_t*)data, readSize);
+	}
+
 	*size = readSize;
 	return SZ_OK;
 };
@@ -65,14 +73,38 @@ namespace sc
 				throw LzmaCompressInitException();
 			}
 
+			reset(props);
+		}
+
+		void Lzma::reset(Props& props)
+		{
+			// Props are copied field by field, so SDK can add new fields without breaking them
+			CLzmaEncProps encoder_props;
+			LzmaEncProps_Init(&encoder_props);
+			encoder_props.level = props.level;
+			encoder_props.dictSize = props.dict_size;
+			encoder_props.lc = props.lc;
+			encoder_props.lp = props.lp;
+			encoder_props.pb = props.pb;
+			encoder_props.algo = static_cast<int>(props.mode);
+			encoder_props.fb = props.fb;
+			encoder_props.btMode = static_cast<int>(props.binaryMode);
+			encoder_props.numHashBytes = props.hash_bytes_count;
+			encoder_props.mc = props.mc;
+			encoder_props.writeEndMark = props.write_end_mark;
+			encoder_props.numThreads = props.threads;
+			encoder_props.reduceSize = props.reduce_size;
+			encoder_props.affinity = props.affinity;
+
 			SRes res;
-			res = LzmaEnc_SetProps(m_context, (CLzmaEncProps*)&props);
+			res = LzmaEnc_SetProps(m_context, &encoder_props);
 			if (res != SZ_OK)
 			{
 				throw LzmaCompressInitException();
 			}
 
 			m_use_long_unpacked_data = props.use_long_unpacked_length;
+			m_write_end_mark = props.write_end_mark;
 		}
 
 		void Lzma::compress_stream(Stream& input, Stream& output)
@@ -92,15 +124,63 @@ namespace sc
 				output.write_unsigned_int(static_cast<uint32_t>(file_size));
 			}
 
+			if (input.data() != nullptr)
+			{
+				BufferStream* buffer = dynamic_cast<BufferStream*>(&output);
+				if (buffer)
+				{
+					compress_memory(input, *buffer, file_size);
+					return;
+				}
+			}
+
 			CSeqInStreamWrap inWrap;
 			inWrap.vt.Read = LzmaStreamRead;
 			inWrap.input = &input;
+			inWrap.callback = &m_input_callback;
 
 			CSeqOutStreamWrap outWrap;
 			outWrap.vt.Write = LzmaStreamWrite;
 			outWrap.output = &output;
 
-			LzmaEnc_Encode(m_context, &outWrap.vt, &inWrap.vt, nullptr, (ISzAllocPtr)&LzmaAlloc, (ISzAllocPtr)&LzmaAlloc);
+			SRes res = LzmaEnc_Encode(m_context, &outWrap.vt, &inWrap.vt, nullptr, (ISzAllocPtr)&LzmaAlloc, (ISzAllocPtr)&LzmaAlloc);
+			if (res != SZ_OK)
+			{
+				throw LzmaCompressException();
+			}
+		}
+
+		void Lzma::compress_memory(Stream& input, BufferStream& output, size_t length)
+		{
+			const uint8_t* source = (const uint8_t*)input.data() + input.position();
+			input.seek(length, Seek::Add);
+
+			if (m_input_callback && length)
+			{
+				m_input_callback(source, length);
+			}
+
+			// Incompressible data grows at most by a third plus stream end
+			size_t position = output.position();
+			size_t buffer_length = output.length();
+			size_t bound = length + length / 3 + 128;
+
+			if (position + bound > buffer_length)
+			{
+				output.resize(position + bound);
+			}
+
+			SizeT compressed_length = bound;
+			SRes res = LzmaEnc_MemEncode(m_context, (uint8_t*)output.data() + position, &compressed_length, source, length,
+				m_write_end_mark, nullptr, (ISzAllocPtr)&LzmaAlloc, (ISzAllocPtr)&LzmaAlloc);
+
+			if (res != SZ_OK)
+			{
+				throw LzmaCompressException();
+			}
+
+			output.resize(std::max(buffer_length, position + compressed_length));
+			output.seek(position + compressed_length);
 		}
 
 		Lzma::~Lzma()
@@ -7,8 +7,22 @@
 #include "exception/MemoryAllocationException.h"
 #include "SupercellCompression/exception/Lzma.h"
 
+#include <string.h>
+
 namespace sc
 {
+	namespace lzma
+	{
+		bool has_optimized_decoder()
+		{
+#ifdef _LZMA_DEC_OPT
+			return true;
+#else
+			return false;
+#endif
+		}
+	}
+
 	namespace Decompressor
 	{
 		struct LzmaDecompressContext : public CLzmaDec {};
@@ -17,88 +31,243 @@ namespace sc
 
 		Lzma::Lzma(uint8_t header[lzma::PROPS_SIZE], const uint64_t unpackedSize) : m_unpacked_size(unpackedSize)
 		{
+			memcpy(m_header, header, lzma::PROPS_SIZE);
+
 			m_context = new LzmaDecompressContext();
 			LzmaDec_Construct(m_context);
 
-			SRes res = LzmaDec_Allocate(m_context, header, LZMA_PROPS_SIZE, (ISzAllocPtr)&LzmaAlloc);
+			// Only probabilities are allocated here, dictionary is allocated later if decompression needs it
+			SRes res = LzmaDec_AllocateProbs(m_context, header, LZMA_PROPS_SIZE, (ISzAllocPtr)&LzmaAlloc);
 			if (res != SZ_OK)
 			{
 				throw LzmaDecompressInitException();
 			}
+		}
+
+		void Lzma::decompress_stream(Stream& input, Stream& output)
+		{
+			bool has_strict_bound = (m_unpacked_size != SIZE_MAX / 2) && (m_unpacked_size != SIZE_MAX);
+
+			// Data that is cut by output limit can only be decoded through dictionary
+			if (has_strict_bound && m_output_limit >= m_unpacked_size)
+			{
+				if (m_unpacked_size == 0)
+				{
+					return;
+				}
+
+				size_t compressed_length = input.length() - input.position();
+
+				uint8_t* destination = reserve_output(output, m_unpacked_size, compressed_length);
+				if (destination)
+				{
+					size_t unpacked_size = m_unpacked_size;
+					decompress_direct(input, destination);
+					commit_output(output, destination, unpacked_size);
+					return;
+				}
 
+				// Data that fits in dictionary is decompressed to buffer of its own size instead of full dictionary
+				if (m_unpacked_size <= m_context->prop.dicSize && can_reserve(m_unpacked_size, compressed_length))
+				{
+					size_t unpacked_size = m_unpacked_size;
+					uint8_t* buffer = memalloc(unpacked_size);
+
+					try
+					{
+						decompress_direct(input, buffer);
+					}
+					catch (...)
+					{
+						free(buffer);
+						throw;
+					}
+
+					size_t written_bytes = write_output(output, buffer, unpacked_size);
+					free(buffer);
+
+					if (written_bytes != unpacked_size)
+						throw LzmaMissingEndMarkException();
+
+					return;
+				}
+			}
+
+			decompress_dictionary(input, output);
+		};
+
+		void Lzma::decompress_direct(Stream& input, uint8_t* destination)
+		{
+			size_t unpacked_size = m_unpacked_size;
+
+			m_context->dic = destination;
+			m_context->dicBufSize = unpacked_size;
 			LzmaDec_Init(m_context);
 
-			m_input_buffer = memalloc(Lzma::Stream_Size);
-			m_output_buffer = memalloc(Lzma::Stream_Size);
+			const uint8_t* input_data = nullptr;
+			size_t in_position = 0, input_size = 0;
+			while (m_context->dicPos < unpacked_size)
+			{
+				if (in_position == input_size)
+				{
+					input_data = next_input(input, input_size);
+					in_position = 0;
+				}
+
+				size_t in_processed = input_size - in_position;
+				size_t dic_position = m_context->dicPos;
+				ELzmaStatus status;
+
+				SRes res = LzmaDec_DecodeToDic(m_context, unpacked_size,
+					input_data + in_position, &in_processed, LZMA_FINISH_END, &status);
+				in_position += in_processed;
+
+				if (res != SZ_OK || (in_processed == 0 && m_context->dicPos == dic_position))
+				{
+					m_context->dic = nullptr;
+					throw LzmaMissingEndMarkException();
+				}
+			}
+
+			// Destination is owned by caller
+			m_context->dic = nullptr;
+			m_context->dicBufSize = 0;
+
+			// Returns unused compressed data back to input
+			input.seek(input.position() - (input_size - in_position));
+
+			m_unpacked_size = 0;
 		}
 
-		void Lzma::decompress_stream(Stream& input, Stream& output)
+		void Lzma::decompress_dictionary(Stream& input, Stream& output)
 		{
 			bool has_strict_bound = (m_unpacked_size != SIZE_MAX / 2) && (m_unpacked_size != SIZE_MAX);
 
-			size_t in_position = 0, input_size = 0, out_position = 0;
-			while (true)
+			SRes res = LzmaDec_Allocate(m_context, m_header, LZMA_PROPS_SIZE, (ISzAllocPtr)&LzmaAlloc);
+			if (res != SZ_OK)
+			{
+				throw LzmaDecompressInitException();
+			}
+			m_owns_dictionary = true;
+
+			LzmaDec_Init(m_context);
+
+			const uint8_t* input_data = nullptr;
+			size_t in_position = 0, input_size = 0;
+			while (m_output_limit != 0)
 			{
 				if (in_position == input_size)
 				{
-					input_size = Lzma::Stream_Size;
-					input.read(m_input_buffer, input_size);
+					input_data = next_input(input, input_size);
 					in_position = 0;
 				}
+
+				if (m_context->dicPos == m_context->dicBufSize)
 				{
-					SRes res;
-					size_t in_processed = input_size - in_position;
-					size_t out_processed = Lzma::Stream_Size - out_position;
-					ELzmaFinishMode finishMode = LZMA_FINISH_ANY;
-					ELzmaStatus status;
-					if (has_strict_bound && out_processed > m_unpacked_size)
-					{
-						out_processed = m_unpacked_size;
-						finishMode = LZMA_FINISH_END;
-					}
+					m_context->dicPos = 0;
+				}
+
+				size_t dic_position = m_context->dicPos;
+				size_t out_size = m_context->dicBufSize - dic_position;
+				ELzmaFinishMode finishMode = LZMA_FINISH_ANY;
+				if (has_strict_bound && out_size >= m_unpacked_size)
+				{
+					out_size = m_unpacked_size;
+					finishMode = LZMA_FINISH_END;
+				}
+
+				// Stream does not end at output limit, so decoding just stops there
+				if (out_size > m_output_limit)
+				{
+					out_size = m_output_limit;
+					finishMode = LZMA_FINISH_ANY;
+				}
+
+				size_t in_processed = input_size - in_position;
+				ELzmaStatus status;
+
+				res = LzmaDec_DecodeToDic(m_context, dic_position + out_size,
+					input_data + in_position, &in_processed, finishMode, &status);
+				in_position += in_processed;
 
-					res = LzmaDec_DecodeToBuf(m_context, m_output_buffer + out_position, &out_processed,
-						m_input_buffer + in_position, &in_processed, finishMode, &status);
-					in_position += in_processed;
-					out_position += out_processed;
+				// Decoded data is written to output right from dictionary
+				size_t out_processed = m_context->dicPos - dic_position;
+				if (has_strict_bound)
+				{
 					m_unpacked_size -= out_processed;
+				}
+
+				if (m_output_limit != SIZE_MAX)
+				{
+					m_output_limit -= out_processed;
+				}
+
+				if (write_output(output, m_context->dic + dic_position, out_processed) != out_processed || res != SZ_OK)
+					throw LzmaMissingEndMarkException();
 
-					if (output.write(m_output_buffer, out_position) != out_position || res != SZ_OK)
+				if (has_strict_bound && m_unpacked_size == 0)
+					// Decompression Success
+					break;
+
+				if (in_processed == 0 && out_processed == 0)
+				{
+					if (has_strict_bound || status != LZMA_STATUS_FINISHED_WITH_MARK)
 						throw LzmaMissingEndMarkException();
 
-					out_position = 0;
+					// Decompression Success
+					break;
+				}
+			}
 
-					if (has_strict_bound && m_unpacked_size == 0)
-						// Decompression Success
-						return;
+			input.seek(input.position() - (input_size - in_position));
+		}
 
-					if (in_processed == 0 && out_processed == 0)
-					{
-						if (has_strict_bound || status != LZMA_STATUS_FINISHED_WITH_MARK)
-							throw LzmaMissingEndMarkException();
+		const uint8_t* Lzma::next_input(Stream& input, size_t& length)
+		{
+			size_t remaining = input.length() - input.position();
 
-						// Decompression Success
-						return;
-					}
+			if (input.data() != nullptr)
+			{
+				const uint8_t* data = (const uint8_t*)input.data() + input.position();
+				input.seek(remaining, Seek::Add);
+
+				length = remaining;
+				return data;
+			}
+
+			if (!m_input_buffer)
+			{
+				// Staging buffer is not bigger than compressed data
+				m_input_buffer_size = remaining < Lzma::Stream_Size ? remaining : Lzma::Stream_Size;
+				if (m_input_buffer_size == 0)
+				{
+					m_input_buffer_size = 1;
 				}
+
+				m_input_buffer = memalloc(m_input_buffer_size);
 			}
-		};
+
+			length = input.read(m_input_buffer, m_input_buffer_size);
+			return m_input_buffer;
+		}
 
 		Lzma::~Lzma()
 		{
-			LzmaDec_Free(m_context, (ISzAllocPtr)&LzmaAlloc);
-
-			if (m_input_buffer)
+			if (m_owns_dictionary)
 			{
-				free(m_input_buffer);
+				LzmaDec_Free(m_context, (ISzAllocPtr)&LzmaAlloc);
+			}
+			else
+			{
+				LzmaDec_FreeProbs(m_context, (ISzAllocPtr)&LzmaAlloc);
 			}
 
-			if (m_output_buffer)
+			if (m_input_buffer)
 			{
-				free(m_output_buffer);
+				free(m_input_buffer);
 			}
 
 			delete m_context;
 		}
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,122 @@
+#include "SupercellCompression/Lzma2.h"
+
+#include "Alloc.h"
+#include "Lzma2Enc.h"
+#include "SupercellCompression/exception/Lzma.h"
+
+const size_t Stream_Size = (4 * 1024 * 1024); // 4MB
+
+struct CLzma2InStreamWrap
+{
+	ISeqInStream vt;
+	sc::Stream* input;
+	const sc::Compressor::CompressionInterface::ChunkCallback* callback;
+};
+
+struct CLzma2OutStreamWrap
+{
+	ISeqOutStream vt;
+	sc::Stream* output;
+};
+
+static SRes Lzma2StreamRead(const ISeqInStream* p, void* data, size_t* size)
+{
+	CLzma2InStreamWrap* wrap = CONTAINER_FROM_VTBL(p, CLzma2InStreamWrap, vt);
+	size_t bufferReadSize = (*size < Stream_Size) ? *size : Stream_Size;
+	size_t readSize = wrap->input->read(data, bufferReadSize);
+
+	if (readSize && *wrap->callback)
+	{
+		(*wrap->callback)((const uint8_t*)data, readSize);
+	}
+
+	*size = readSize;
+	return SZ_OK;
+};
+
+static size_t Lzma2StreamWrite(const ISeqOutStream* p, const void* buf, size_t size)
+{
+	auto* wrap = CONTAINER_FROM_VTBL(p, CLzma2OutStreamWrap, vt);
+	return wrap->output->write((void*)buf, size);
+};
+
+namespace sc
+{
+	namespace Compressor
+	{
+		static const void* Lzma2Alloc[] = { (void*)&sc::lzma::lzma_alloc, (void*)&sc::lzma::lzma_free };
+
+		Lzma2::Lzma2(Props& props)
+		{
+			m_context = Lzma2Enc_Create((ISzAllocPtr)&Lzma2Alloc, (ISzAllocPtr)&Lzma2Alloc);
+			if (!m_context)
+			{
+				throw LzmaCompressInitException();
+			}
+
+			CLzma2EncProps encoder_props;
+			Lzma2EncProps_Init(&encoder_props);
+			encoder_props.lzmaProps.level = props.level;
+			encoder_props.lzmaProps.dictSize = props.dict_size;
+			encoder_props.lzmaProps.lc = props.lc;
+			encoder_props.lzmaProps.lp = props.lp;
+			encoder_props.lzmaProps.pb = props.pb;
+			encoder_props.blockSize = props.block_size;
+
+			// Encoder splits threads between blocks and match finders of every block by itself
+			encoder_props.numTotalThreads = props.threads_count == 0 ? 1 : (int)props.threads_count;
+
+			SRes res = Lzma2Enc_SetProps(m_context, &encoder_props);
+			if (res != SZ_OK)
+			{
+				throw LzmaCompressInitException();
+			}
+		}
+
+		void Lzma2::compress_stream(Stream& input, Stream& output)
+		{
+			size_t file_size = input.length() - input.position();
+			Lzma2Enc_SetDataSize(m_context, file_size);
+
+			output.write_unsigned_byte(Lzma2Enc_WriteProperties(m_context));
+			output.write_unsigned_long(file_size);
+
+			CLzma2OutStreamWrap outWrap;
+			outWrap.vt.Write = Lzma2StreamWrite;
+			outWrap.output = &output;
+
+			SRes res;
+			if (input.data() != nullptr)
+			{
+				// Data in memory is split between blocks without copying
+				const uint8_t* data = (const uint8_t*)input.data() + input.position();
+				if (m_input_callback && file_size)
+				{
+					m_input_callback(data, file_size);
+				}
+
+				res = Lzma2Enc_Encode2(m_context, &outWrap.vt, nullptr, nullptr, nullptr, data, file_size, nullptr);
+				input.seek(file_size, Seek::Add);
+			}
+			else
+			{
+				CLzma2InStreamWrap inWrap;
+				inWrap.vt.Read = Lzma2StreamRead;
+				inWrap.input = &input;
+				inWrap.callback = &m_input_callback;
+
+				res = Lzma2Enc_Encode2(m_context, &outWrap.vt, nullptr, nullptr, &inWrap.vt, nullptr, 0, nullptr);
+			}
+
+			if (res != SZ_OK)
+			{
+				throw LzmaCompressException();
+			}
+		}
+
+		Lzma2::~Lzma2()
+		{
+			Lzma2Enc_Destroy(m_context);
+		}
+	}
+}
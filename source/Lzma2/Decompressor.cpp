@@ -0,0 +1,148 @@
+#include "SupercellCompression/Lzma2.h"
+
+#include "Alloc.h"
+#include "Lzma2DecMt.h"
+#include "SupercellCompression/exception/Lzma.h"
+
+#include <string.h>
+#include <algorithm>
+
+struct CLzma2DecInStreamWrap
+{
+	ISeqInStream vt;
+	sc::Stream* input;
+};
+
+struct CLzma2DecOutStreamWrap
+{
+	ISeqOutStream vt;
+	sc::Stream* output;
+	const sc::Decompressor::DecompressionInterface::ChunkCallback* callback;
+	uint64_t written_length;
+
+	// Reserved output memory. Data is copied there and committed to output after decoding
+	uint8_t* destination;
+	uint64_t destination_length;
+};
+
+static SRes Lzma2DecStreamRead(const ISeqInStream* p, void* data, size_t* size)
+{
+	CLzma2DecInStreamWrap* wrap = CONTAINER_FROM_VTBL(p, CLzma2DecInStreamWrap, vt);
+	*size = wrap->input->read(data, *size);
+	return SZ_OK;
+};
+
+static size_t Lzma2DecStreamWrite(const ISeqOutStream* p, const void* buf, size_t size)
+{
+	auto* wrap = CONTAINER_FROM_VTBL(p, CLzma2DecOutStreamWrap, vt);
+
+	if (wrap->destination)
+	{
+		// Data longer than header says is an error
+		if (size > wrap->destination_length - wrap->written_length)
+		{
+			return 0;
+		}
+
+		memcpy(wrap->destination + wrap->written_length, buf, size);
+		wrap->written_length += size;
+		return size;
+	}
+
+	size_t written = wrap->output->write((void*)buf, size);
+
+	if (written && *wrap->callback)
+	{
+		(*wrap->callback)((const uint8_t*)buf, written);
+	}
+
+	wrap->written_length += written;
+	return written;
+};
+
+namespace sc
+{
+	namespace Decompressor
+	{
+		static const void* Lzma2Alloc[] = { (void*)&sc::lzma::lzma_alloc, (void*)&sc::lzma::lzma_free };
+
+		Lzma2::Lzma2(Props& props) :
+			m_dict_size_prop(props.dict_size_prop),
+			m_unpacked_length(props.unpacked_length),
+			m_threads_count(props.threads_count == 0 ? 1 : props.threads_count)
+		{
+			m_context = Lzma2DecMt_Create((ISzAllocPtr)&Lzma2Alloc, (ISzAllocPtr)&Lzma2Alloc);
+			if (!m_context)
+			{
+				throw LzmaDecompressInitException();
+			}
+		}
+
+		void Lzma2::decompress_stream(Stream& input, Stream& output)
+		{
+			bool has_strict_bound = m_unpacked_length != lzma2::UNKNOWN_LENGTH;
+
+			// Output buffer is allocated once instead of growing with every decoded block
+			size_t output_length = output.length();
+			uint8_t* destination = nullptr;
+			if (has_strict_bound && m_unpacked_length <= SIZE_MAX)
+			{
+				destination = reserve_output(output, static_cast<size_t>(m_unpacked_length), input.length() - input.position());
+			}
+
+			CLzma2DecMtProps decoder_props;
+			Lzma2DecMtProps_Init(&decoder_props);
+#ifndef _7ZIP_ST
+			decoder_props.numThreads = m_threads_count;
+#endif
+
+			CLzma2DecInStreamWrap inWrap;
+			inWrap.vt.Read = Lzma2DecStreamRead;
+			inWrap.input = &input;
+
+			CLzma2DecOutStreamWrap outWrap;
+			outWrap.vt.Write = Lzma2DecStreamWrite;
+			outWrap.output = &output;
+			outWrap.callback = &m_output_callback;
+			outWrap.written_length = 0;
+			outWrap.destination = destination;
+			outWrap.destination_length = m_unpacked_length;
+
+			UInt64 unpacked_length = m_unpacked_length;
+			UInt64 in_processed = 0;
+			int is_mt_mode = 0;
+
+			SRes res = Lzma2DecMt_Decode(m_context, m_dict_size_prop, &decoder_props, &outWrap.vt,
+				has_strict_bound ? &unpacked_length : nullptr, 1,
+				&inWrap.vt, &in_processed, &is_mt_mode, nullptr);
+
+			// Only decoded data is committed, buffer grown by reserve_output is cut back if data ended early
+			if (destination)
+			{
+				commit_output(output, destination, static_cast<size_t>(outWrap.written_length));
+
+				BufferStream* buffer = dynamic_cast<BufferStream*>(&output);
+				size_t data_end = std::max(output_length, output.position());
+				if (buffer && buffer->length() > data_end)
+				{
+					buffer->resize(data_end);
+				}
+			}
+
+			if (res != SZ_OK)
+			{
+				throw LzmaCorruptedDecompressException();
+			}
+
+			if (has_strict_bound && outWrap.written_length != m_unpacked_length)
+			{
+				throw LzmaMissingEndMarkException();
+			}
+		}
+
+		Lzma2::~Lzma2()
+		{
+			Lzma2DecMt_Destroy(m_context);
+		}
+	}
+}
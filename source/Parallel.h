@@ -0,0 +1,140 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sc
+{
+	// Runs job on threads_count threads (including calling one) and waits until all of them are finished.
+	// Each job receives index of its thread in range [0, threads_count). Job must not throw.
+	inline void parallel_run(uint32_t threads_count, const std::function<void(uint32_t)>& job)
+	{
+		if (threads_count <= 1)
+		{
+			job(0);
+			return;
+		}
+
+		std::vector<std::thread> threads;
+		threads.reserve(threads_count - 1);
+
+		for (uint32_t thread_index = 1; threads_count > thread_index; thread_index++)
+		{
+			threads.emplace_back(job, thread_index);
+		}
+
+		job(0);
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	// Same as parallel_run, but threads are started once and wait for next job between runs.
+	// Used by objects that process many images or bands, so threads are not created for each of them.
+	class ThreadPool
+	{
+	public:
+		// Starts threads_count - 1 threads, calling thread is always the first one
+		ThreadPool(uint32_t threads_count)
+		{
+			for (uint32_t thread_index = 1; threads_count > thread_index; thread_index++)
+			{
+				m_threads.emplace_back(&ThreadPool::work, this, thread_index);
+			}
+		}
+
+		~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+			m_start.notify_all();
+
+			for (std::thread& thread : m_threads)
+			{
+				thread.join();
+			}
+		}
+
+		uint32_t threads_count() const
+		{
+			return (uint32_t)m_threads.size() + 1;
+		}
+
+		// Runs job on threads_count threads of pool (including calling one) and waits until all of them are finished.
+		// Number of threads is limited by size of pool. Job must not throw.
+		void run(uint32_t threads_count, const std::function<void(uint32_t)>& job)
+		{
+			threads_count = std::min(threads_count, this->threads_count());
+			if (threads_count <= 1)
+			{
+				job(0);
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_job = &job;
+				m_job_threads_count = threads_count;
+				m_running_count = threads_count - 1;
+				m_generation++;
+			}
+			m_start.notify_all();
+
+			job(0);
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_finish.wait(lock, [this] { return m_running_count == 0; });
+			m_job = nullptr;
+		}
+
+	private:
+		void work(uint32_t thread_index)
+		{
+			uint64_t generation = 0;
+			while (true)
+			{
+				const std::function<void(uint32_t)>* job;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_start.wait(lock, [this, generation] { return m_stop || m_generation != generation; });
+					if (m_stop) return;
+
+					generation = m_generation;
+					if (thread_index >= m_job_threads_count) continue;
+					job = m_job;
+				}
+
+				(*job)(thread_index);
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (--m_running_count == 0)
+				{
+					m_finish.notify_one();
+				}
+			}
+		}
+
+	private:
+		std::vector<std::thread> m_threads;
+
+		std::mutex m_mutex;
+		std::condition_variable m_start;
+		std::condition_variable m_finish;
+
+		// Current job and number of threads that run it. Generation changes with every run
+		const std::function<void(uint32_t)>* m_job = nullptr;
+		uint32_t m_job_threads_count = 0;
+		uint32_t m_running_count = 0;
+		uint64_t m_generation = 0;
+		bool m_stop = false;
+	};
+}
@@ -1,6 +1,13 @@
 #include "SupercellCompression/ScCompression.h"
+#include "SupercellCompression/Sc/Tuning.h"
+#include "SupercellCompression/exception/ScCompression.h"
 #include "generic/md5.h"
 #include "io/buffer_stream.h"
+#include "io/memory_stream.h"
+
+#include <float.h>
+#include <algorithm>
+#include <chrono>
 
 #define HASH_LENGTH 16
 
@@ -28,7 +35,106 @@ namespace sc {
 				input.write_unsigned_int(static_cast<uint32_t>(metadata.length()), Endian::Big);
 			}
 
-			void compress(Stream& input, Stream& output, CompressorContext& context)
+			static void compress_data(Stream& input, Stream& output, CompressorContext& context, Signature signature, size_t tuning_length);
+
+			Signature select_signature(Stream& input, CompressorContext& context)
+			{
+				using namespace std::chrono;
+
+				const AutoSelection& selection = context.auto_selection;
+
+				size_t position = input.position();
+				size_t input_length = input.length() - position;
+				if (input_length == 0)
+				{
+					return Signature::Zstandard;
+				}
+
+				// Samples are taken evenly across input. If they cover whole input, input is used as a single sample
+				uint32_t samples_count = std::max<uint32_t>(selection.samples_count, 1);
+				size_t sample_size = std::max<size_t>(selection.sample_size, 1);
+				if (sample_size * samples_count >= input_length)
+				{
+					samples_count = 1;
+					sample_size = input_length;
+				}
+
+				std::vector<std::vector<uint8_t>> samples(samples_count);
+				for (uint32_t i = 0; samples_count > i; i++)
+				{
+					size_t offset = samples_count > 1 ? (input_length - sample_size) * i / (samples_count - 1) : 0;
+
+					samples[i].resize(sample_size);
+					input.seek(position + offset);
+					input.read(samples[i].data(), sample_size);
+				}
+				input.seek(position);
+
+				// Samples are split into frames and use dictionary the same way as whole input
+				CompressorContext sample_context = context;
+				sample_context.write_assets = false;
+				sample_context.write_seek_table = false;
+
+				// Decompression speed is measured in a single thread, like data is usually loaded
+				Decompressor::DecompressorContext decompressor_context;
+				decompressor_context.threads_count = 1;
+				decompressor_context.dictionary = context.dictionary;
+
+				Signature result = Signature::Zstandard;
+				size_t result_length = SIZE_MAX;
+				double result_speed = -1.0;
+				bool result_fast_enough = false;
+
+				for (Signature signature : { Signature::Zstandard, Signature::Lzma, Signature::Lzham })
+				{
+					sample_context.signature = signature;
+
+					size_t compressed_length = 0;
+					high_resolution_clock::duration decompress_time{ 0 };
+
+					for (std::vector<uint8_t>& sample : samples)
+					{
+						MemoryStream sample_stream(sample.data(), sample.size());
+						BufferStream compressed;
+						// Props are tuned for whole input, so samples are compressed with the same settings as file
+						compress_data(sample_stream, compressed, sample_context, signature, input_length);
+						compressed_length += compressed.length();
+
+						compressed.seek(0);
+						BufferStream decompressed;
+
+						time_point start = high_resolution_clock::now();
+						Decompressor::decompress(compressed, decompressed, decompressor_context);
+						decompress_time += high_resolution_clock::now() - start;
+					}
+
+					double seconds = duration<double>(decompress_time).count();
+					double speed = seconds > 0.0 ? (double)(sample_size * samples_count) / (1024 * 1024) / seconds : DBL_MAX;
+					bool fast_enough = speed >= selection.min_decode_speed;
+
+					if (fast_enough)
+					{
+						if (!result_fast_enough || result_length > compressed_length)
+						{
+							result = signature;
+							result_length = compressed_length;
+							result_fast_enough = true;
+						}
+					}
+					else if (!result_fast_enough && speed > result_speed)
+					{
+						result = signature;
+						result_speed = speed;
+					}
+				}
+
+				return result;
+			}
+
+
+			// Writes SC file with specified codec. Codec props are tuned for tuning_length bytes of input,
+			// so samples of input can be compressed with the same props as whole input
+			static void compress_data(Stream& input, Stream& output, CompressorContext& context, Signature signature, size_t tuning_length)
 			{
 				using namespace sc::Compressor;
 
@@ -40,7 +146,7 @@ namespace sc {
 				}
 
 				// Signature check
-				switch (context.signature)
+				switch (signature)
 				{
 				case Signature::Lzma:
 				case Signature::Lzham:
@@ -49,55 +155,63 @@ namespace sc {
 				case Signature::Zstandard:
 					output.write_int(3, Endian::Big);
 					break;
+				case Signature::Auto:
+					// Codec must be selected before writing
+					throw ScUnknownVersionException();
 				}
 
 				// Hash
+				// Input is read only once, so hash is calculated from the same chunks that codec consumes
+				// and written to its place in header when compression is finished
+				md5 md_ctx;
+				size_t input_length = input.length() - input.position();
+				size_t hash_position = 0;
 				{
-					md5 md_ctx;
-					uint8_t hash[HASH_LENGTH];
-
-					md_ctx.update((uint8_t*)input.data(), input.length());
-
-					md_ctx.final(hash);
+					uint8_t hash[HASH_LENGTH] = { 0 };
 
 					output.write_unsigned_int(HASH_LENGTH, Endian::Big);
+					hash_position = output.position();
 					output.write(&hash, HASH_LENGTH);
 				}
 
-				switch (context.signature)
+				CompressionInterface::ChunkCallback hash_callback = [&md_ctx](const uint8_t* data, size_t length)
+					{
+						md_ctx.update((uint8_t*)data, length);
+					};
+
+				switch (signature)
 				{
 				case Signature::Lzma:
 				{
 					Lzma::Props props;
-					props.level = 6;
 					props.pb = 2;
 					props.lc = 3;
 					props.lp = 0;
-					props.threads = context.threads_count > 1 ? 2 : 1;
-					props.dict_size = 262144;
 					props.use_long_unpacked_length = false;
-
-					if (input.length() > 1 << 28)
-						props.lc = 4;
+					tune_props(props, tuning_length, context.threads_count);
 
 					sc::Compressor::Lzma compression(props);
+					compression.set_input_callback(hash_callback);
 					compression.compress_stream(input, output);
 				}
 				break;
 
 				case Signature::Lzham:
 				{
-					const uint32_t dictionary_size = 18;
+					Lzham::Props props;
+					tune_props(props, tuning_length, context.threads_count);
+					if (!context.lzham_large_dictionary)
+					{
+						props.dict_size_log2 = std::min(props.dict_size_log2, SCLZ_DEFAULT_DICT_SIZE_LOG2);
+					}
 
+					// Dictionary size is stored in header, so decompressor does not depend on tuning
 					output.write_unsigned_int(SCLZ_MAGIC);
-					output.write_unsigned_byte(dictionary_size);
-					output.write_unsigned_int(static_cast<uint32_t>(input.length() - input.position()));
-
-					Lzham::Props props;
-					props.dict_size_log2 = dictionary_size;
-					props.max_helper_threads = static_cast<uint16_t>(context.threads_count > 0 && context.threads_count < lzham::MAX_HELPER_THREADS ? context.threads_count : -1);
+					output.write_unsigned_byte(static_cast<uint8_t>(props.dict_size_log2));
+					output.write_unsigned_int(static_cast<uint32_t>(input_length));
 
 					sc::Compressor::Lzham compression(props);
+					compression.set_input_callback(hash_callback);
 					compression.compress_stream(input, output);
 				}
 				break;
@@ -105,15 +219,32 @@ namespace sc {
 				case Signature::Zstandard:
 				{
 					Zstd::Props props;
-					props.compression_level = 16;
 					props.checksum_flag = false;
 					props.content_size_flag = true;
-					props.workers_count = context.threads_count;
+					tune_props(props, context.frame_size ? std::min(context.frame_size, tuning_length) : tuning_length, context.threads_count);
+					props.frame_size = context.frame_size;
+					props.write_seek_table = context.write_seek_table;
+					props.dictionary = context.dictionary;
 
 					sc::Compressor::Zstd compression(props);
+					compression.set_input_callback(hash_callback);
 					compression.compress_stream(input, output);
 				}
 				break;
+
+				case Signature::Auto:
+					throw ScUnknownVersionException();
+				}
+
+				// Hash backpatching
+				{
+					uint8_t hash[HASH_LENGTH];
+					md_ctx.final(hash);
+
+					size_t end_position = output.position();
+					output.seek(hash_position);
+					output.write(&hash, HASH_LENGTH);
+					output.seek(end_position);
 				}
 
 				if (context.write_assets)
@@ -121,6 +252,13 @@ namespace sc {
 					write_metadata(output);
 				}
 			}
+
+			void compress(Stream& input, Stream& output, CompressorContext& context)
+			{
+				Signature signature = context.signature == Signature::Auto ? select_signature(input, context) : context.signature;
+
+				compress_data(input, output, context, signature, input.length() - input.position());
+			}
 		}
 	}
 }
\ No newline at end of file
@@ -1,7 +1,15 @@
 #include "SupercellCompression/ScCompression.h"
 
+#include <string.h>
+#include <algorithm>
+
 #include "io/memory_stream.h"
+#include "io/buffer_stream.h"
+#include "generic/md5.h"
 #include "exception/io/BinariesExceptions.h"
+#include "SupercellCompression/exception/ScCompression.h"
+
+#define HASH_LENGTH 16
 
 namespace sc {
 	namespace ScCompression
@@ -10,284 +18,216 @@ namespace sc {
 		{
 			void read_metadata(uint8_t* buffer_end, MetadataAssetArray& metadataArray)
 			{
-				uint32_t asset_total_count = 0;
-				bool unknown_bool = false;
+				MetadataView metadata(buffer_end, false);
 
-				uint8_t* metadata_header = buffer_end - 6;
-
-				// -- Strings and Hashes data --
-				uint32_t strings_info_field_size = 0;
-				uint8_t hash_info_field_size = 0;
+				metadataArray.reserve(metadataArray.size() + metadata.size());
+				for (MetadataView::Asset asset : metadata)
+				{
+					MetadataAsset& item = metadataArray.emplace_back();
+					item.name = std::string(asset.name);
+					item.hash = std::vector<char>((const char*)asset.hash, (const char*)asset.hash + asset.hash_length);
+				}
+			}
 
-				uint8_t* asset_info_ptr = nullptr;
-				uint8_t* strings_ptr = nullptr;
+			void decompress(Stream& input, Stream& output, MetadataAssetArray* metadataArray)
+			{
+				DecompressorContext context;
+				decompress(input, output, context, metadataArray);
+			}
 
-				char info_field_size = 0;
-				char metadata_flags = *(char*)metadata_header;
-				if ((metadata_flags & 0xFC) == 0x24)
-				{
-					// -- Initial Part --
-					uint8_t asset_info_field_size = *(metadata_header + 1);
+			void decompress(Stream& input, Stream& output, DecompressorContext& context, MetadataAssetArray* metadataArray)
+			{
+				using namespace sc::Decompressor;
 
-					uint8_t* asset_info_offset_ptr = metadata_header - asset_info_field_size;
+				Info info = inspect(input);
 
-					uint32_t asset_info_offset;
-					if (asset_info_field_size > 3)
-					{
-						asset_info_offset = *(uint32_t*)asset_info_offset_ptr;
-					}
-					else if (asset_info_field_size <= 1)
+				if (info.has_metadata && metadataArray)
+				{
+					if (input.data() != nullptr)
 					{
-						asset_info_offset = *asset_info_offset_ptr;
+						uint8_t* buffer_end = (uint8_t*)input.data() + input.length();
+						read_metadata(buffer_end, *metadataArray);
 					}
 					else
 					{
-						asset_info_offset = *(uint16_t*)asset_info_offset_ptr;
+						std::vector<uint8_t> metadata_buffer(input.length() - info.metadata_offset);
+						input.seek(info.metadata_offset);
+						input.read(metadata_buffer.data(), metadata_buffer.size());
+						read_metadata(metadata_buffer.data() + metadata_buffer.size(), *metadataArray);
 					}
+				}
 
-					// -- Second Part --
-					asset_info_ptr = asset_info_offset_ptr - asset_info_offset;
+				input.seek(info.data_offset);
 
-					char strings_bits_offset = metadata_flags & 3;
-					info_field_size = 1ULL << (metadata_flags & 3);
-					if (info_field_size >= 3u)
-					{
-						int32_t strings_data_offset = 0xFFFFFFFDULL << strings_bits_offset;
-						if (info_field_size >= 8u)
-						{
-							uint8_t* string_data_ptr = asset_info_ptr + strings_data_offset;
+				// Data of memory streams (buffers or mapped files) is passed to decompressor without copying.
+				// Other streams (like file streams) are read by decompressor in chunks
+				bool in_memory = input.data() != nullptr;
+				MemoryStream memory_data(in_memory ? (uint8_t*)input.data() + info.data_offset : nullptr, in_memory ? info.data_length : 0);
+				Stream& compressed_data = in_memory ? static_cast<Stream&>(memory_data) : input;
 
-							strings_info_field_size = 8;
-							hash_info_field_size = 8;
+				// Hash is calculated from the same chunks that decompressor writes to output
+				md5 md_ctx;
+				bool verify_hash = context.verify_hash && info.hash.size() == HASH_LENGTH;
 
-							strings_ptr = &asset_info_ptr[strings_data_offset - *(uint32_t*)&asset_info_ptr[strings_data_offset]];
-							strings_info_field_size = *(uint8_t*)(string_data_ptr + info_field_size);
-						}
-						else
+				DecompressionInterface::ChunkCallback hash_callback;
+				if (verify_hash)
+				{
+					hash_callback = [&md_ctx](const uint8_t* data, size_t length)
 						{
-							hash_info_field_size = 1ULL << (metadata_flags & 3);
-
-							strings_info_field_size = *(uint32_t*)&asset_info_ptr[strings_data_offset + info_field_size];
-
-							uint32_t strings_array_offset = *(uint32_t*)(asset_info_ptr + strings_data_offset);
-
-							int strings_offset = strings_data_offset - strings_array_offset;
-							strings_ptr = asset_info_ptr + strings_offset;
-						}
-
-						asset_total_count = *(uint32_t*)(asset_info_ptr - info_field_size);
-						unknown_bool = false;
-					}
-					else if (info_field_size > 1u)
-					{
-						hash_info_field_size = 1ULL << (metadata_flags & 3);
-
-						int bit_offset = 0xFFFFFFFD << strings_bits_offset;
-						uint8_t* strings_array_data_offset = &asset_info_ptr[bit_offset];
-
-						strings_ptr = &strings_array_data_offset[-*(uint16_t*)strings_array_data_offset];
+							md_ctx.update((uint8_t*)data, length);
+						};
+				}
 
-						strings_info_field_size = *(uint16_t*)(strings_array_data_offset + info_field_size);
+				switch (info.signature)
+				{
+				case Signature::Zstandard:
+				{
+					Zstd::Props props;
+					props.threads_count = context.threads_count;
+					props.dictionary = context.dictionary;
+					Zstd decompressor(props);
+					decompressor.set_output_callback(hash_callback);
+					decompressor.decompress_stream(compressed_data, output);
+				}
+				break;
 
-						asset_total_count = *(uint16_t*)(asset_info_ptr - info_field_size);
-						unknown_bool = true;
-					}
-					else
-					{
-						strings_info_field_size = asset_info_ptr[-2];
+				case Signature::Lzham:
+				{
+					// Skip SCLZ magic
+					compressed_data.seek(4, Seek::Add);
+					Lzham::Props props;
+					props.dict_size_log2 = compressed_data.read_unsigned_byte();
+					props.unpacked_length = compressed_data.read_unsigned_int();
+					sc::Decompressor::Lzham decompressor(props);
+					decompressor.set_output_callback(hash_callback);
+					decompressor.decompress_stream(compressed_data, output);
+				}
+				break;
 
-						strings_ptr = &asset_info_ptr[-3 - asset_info_ptr[-3]];
+				case Signature::Lzma:
+				{
+					uint8_t header[lzma::PROPS_SIZE];
+					compressed_data.read(header, lzma::PROPS_SIZE);
 
-						asset_total_count = asset_info_ptr[-info_field_size];
+					uint32_t unpacked_length = compressed_data.read_unsigned_int();
 
-						strings_info_field_size = 1;
-						hash_info_field_size = 1;
-					}
+					// All bits set means that length is unknown and data ends with end marker
+					Lzma decompressor(header, unpacked_length == UINT32_MAX ? SIZE_MAX : unpacked_length);
+					decompressor.set_output_callback(hash_callback);
+					decompressor.decompress_stream(compressed_data, output);
 				}
-				else
-				{
-					return;
+				break;
+
+				case Signature::Auto:
+					throw ScUnknownVersionException();
 				}
 
-				// -- Last part --
-				if (asset_total_count)
+				if (verify_hash)
 				{
-					// Here we get number of strings and hashes. For some reason, in theory, there can be a different number of them.
-					uint32_t strings_total_count;
-					uint32_t hash_total_count;
+					uint8_t data_hash[HASH_LENGTH];
+					md_ctx.final(data_hash);
 
-					if (strings_info_field_size > 3)
-					{
-						strings_total_count = *(uint32_t*)(strings_ptr - strings_info_field_size);
-					}
-					else if (strings_info_field_size > 1)
+					if (memcmp(data_hash, info.hash.data(), HASH_LENGTH) != 0)
 					{
-						strings_total_count = *(uint16_t*)(strings_ptr - strings_info_field_size);
+						throw ScCorruptedHashException();
 					}
-					else
-					{
-						strings_total_count = *(uint8_t*)(strings_ptr - strings_info_field_size);
-					}
-
-					if (unknown_bool)
-					{
-						if (hash_info_field_size > 1u)
-							hash_total_count = *(uint16_t*)&asset_info_ptr[-info_field_size];
-						else
-							hash_total_count = asset_info_ptr[-info_field_size];
-					}
-					else
-					{
-						hash_total_count = *(uint32_t*)&asset_info_ptr[-info_field_size];
-					}
-
-					uint8_t* hash_flags_ptr = &asset_info_ptr[hash_total_count * info_field_size];
+				}
+			}
 
-					for (uint32_t i = 0; asset_total_count > i; i++)
-					{
-						MetadataAsset asset;
+			void decompress_range(Stream& input, Stream& output, size_t offset, size_t length)
+			{
+				DecompressorContext context;
+				decompress_range(input, output, context, offset, length);
+			}
 
-						uint8_t* string_offset_ptr = strings_ptr + i * strings_info_field_size;
-						int string_offset = 0;
+			void decompress_range(Stream& input, Stream& output, DecompressorContext& context, size_t offset, size_t length)
+			{
+				using namespace sc::Decompressor;
 
-						if (strings_total_count > i)
-						{
-							if (strings_info_field_size > 3)
-							{
-								string_offset = *(uint32_t*)string_offset_ptr;
-							}
-							else if (strings_info_field_size <= 1)
-							{
-								string_offset = *string_offset_ptr;
-							}
-							else
-							{
-								string_offset = *(uint16_t*)string_offset_ptr;
-							}
-
-							asset.name = std::string((const char*)&string_offset_ptr[-string_offset]);
-						}
+				Info info = inspect(input);
 
-						if (hash_total_count > i)
-						{
-							uint8_t hash_flag = hash_flags_ptr[i];
-							bool is_valid_hash = hash_flag >> 2 == 0x19;
-							if (hash_flag >> 2 != 0x19)
-								is_valid_hash = hash_flag >> 2 == 5;
-
-							if (is_valid_hash)
-							{
-								uint8_t* hash_offset_ptr = &asset_info_ptr[i * info_field_size];
-
-								int32_t hash_offset;
-								if (hash_info_field_size > 3u)
-								{
-									hash_offset = *(uint32_t*)hash_offset_ptr;
-								}
-								else if (hash_info_field_size <= 1u) {
-									hash_offset = *hash_offset_ptr;
-								}
-								else
-								{
-									hash_offset = *(uint16_t*)hash_offset_ptr;
-								}
-
-								uint8_t hash_length_field_size = 1ULL << (hash_flag & 3);
-
-								uint8_t* hash_ptr = &hash_offset_ptr[-hash_offset];
-								uint32_t hash_size = 0;
-								if (hash_length_field_size > 3u)
-								{
-									hash_size = *(uint32_t*)&hash_ptr[-hash_length_field_size];
-								}
-								else if (hash_length_field_size > 1u)
-								{
-									hash_size = *(uint16_t*)&hash_ptr[-hash_length_field_size];
-								}
-								else
-								{
-									hash_size = hash_ptr[-hash_length_field_size];
-								}
-
-								asset.hash = std::vector<char>((char*)hash_ptr, (char*)hash_ptr + hash_size);
-							}
-						}
+				if (info.signature == Signature::Zstandard)
+				{
+					Zstd::Props props;
+					props.threads_count = context.threads_count;
+					props.dictionary = context.dictionary;
+					Zstd decompressor(props);
 
-						metadataArray.push_back(asset);
+					// Seek table is at the end of compressed data, before metadata of version 4 files
+					if (input.data() == nullptr)
+					{
+						input.seek(info.data_offset);
+						decompressor.decompress_range(input, output, offset, length, info.data_length);
+						return;
 					}
-				}
-			}
 
-			void decompress(Stream& input, Stream& output, MetadataAssetArray* metadataArray)
-			{
-				using namespace sc::Decompressor;
+					MemoryStream compressed_data((uint8_t*)input.data() + info.data_offset, info.data_length);
+					decompressor.decompress_range(compressed_data, output, offset, length);
+					return;
+				}
 
-				int16_t magic = input.read_unsigned_short(Endian::Big);
-				if (magic != SC_MAGIC)
+				// LZMA and LZHAM streams can not be decompressed from the middle, so data is streamed from the start
+				// and decompression stops at output limit as soon as range end is reached
+				size_t range_end = length > SIZE_MAX - offset ? SIZE_MAX : offset + length;
+				if (info.unpacked_length != Info::UnknownLength && range_end > info.unpacked_length)
 				{
-					throw BadMagicException((uint8_t*)&SC_MAGIC, (uint8_t*)&magic, sizeof(uint16_t));
+					range_end = static_cast<size_t>(info.unpacked_length);
 				}
 
-				uint8_t* compressed_data_ptr = nullptr;
-				size_t compressed_data_length = input.length();
-
-				uint32_t version = input.read_unsigned_int(Endian::Big);
-				if (version == 4)
+				if (offset >= range_end)
 				{
-					version = input.read_unsigned_int(Endian::Big);
-
-					uint8_t* buffer_end = (uint8_t*)input.data() + input.length();
+					return;
+				}
 
-					uint32_t chunk_length = swap_endian(*(uint32_t*)(buffer_end - 4));
+				input.seek(info.data_offset);
 
-					// metadata_length + metadata_length_bytes_size + START length
-					compressed_data_length -= chunk_length;
-					compressed_data_length -= 4 + 5;
+				bool in_memory = input.data() != nullptr;
+				MemoryStream memory_data(in_memory ? (uint8_t*)input.data() + info.data_offset : nullptr, in_memory ? info.data_length : 0);
+				Stream& compressed_data = in_memory ? static_cast<Stream&>(memory_data) : input;
 
-					if (metadataArray)
+				// Every decompressed chunk is written to the same buffer, only range part of it goes to output
+				BufferStream chunk;
+				size_t unpacked_position = 0;
+				DecompressionInterface::ChunkCallback range_callback = [&](const uint8_t* data, size_t chunk_length)
 					{
-						read_metadata(buffer_end, *metadataArray);
-					}
-				}
-
-				uint32_t hash_length = input.read_unsigned_int(Endian::Big);
-
-				std::vector<uint8_t> hash(hash_length);
-				input.read(hash.data(), hash_length);
+						size_t chunk_end = unpacked_position + chunk_length;
+						if (chunk_end > offset)
+						{
+							size_t begin = std::max(offset, unpacked_position) - unpacked_position;
+							size_t end = std::min(range_end, chunk_end) - unpacked_position;
+							output.write(data + begin, end - begin);
+						}
 
-				compressed_data_ptr = (uint8_t*)input.data() + input.position();
-				compressed_data_length -= input.position();
+						unpacked_position = chunk_end;
+						chunk.seek(0);
+					};
 
-				if (version == 3)
+				if (info.signature == Signature::Lzham)
 				{
-					MemoryStream compressed_data(compressed_data_ptr, compressed_data_length);
-					Zstd context;
-					context.decompress_stream(compressed_data, output);
+					// Skip SCLZ magic
+					compressed_data.seek(4, Seek::Add);
+					Lzham::Props props;
+					props.dict_size_log2 = compressed_data.read_unsigned_byte();
+					compressed_data.read_unsigned_int();
+
+					// Unknown length makes decompressor stream data instead of decompressing it at once
+					props.unpacked_length = SIZE_MAX;
+					Lzham decompressor(props);
+					decompressor.set_output_callback(range_callback);
+					decompressor.set_output_limit(range_end);
+					decompressor.decompress_stream(compressed_data, chunk);
 				}
-				else if (version == 1)
+				else
 				{
-					// If SCLZ
-					if (*(uint32_t*)compressed_data_ptr == 0x5A4C4353)
-					{
-						MemoryStream compressed_data(compressed_data_ptr + 4, compressed_data_length - 4);
-						Lzham::Props props;
-						props.dict_size_log2 = compressed_data.read_unsigned_byte();
-						props.unpacked_length = compressed_data.read_unsigned_int();
-						sc::Decompressor::Lzham context(props);
-						context.decompress_stream(compressed_data, output);
-					}
-					else
-					{
-						MemoryStream compressed_data(compressed_data_ptr, compressed_data_length);
-
-						uint8_t header[lzma::PROPS_SIZE];
-						compressed_data.read(header, lzma::PROPS_SIZE);
-
-						uint32_t unpacked_length = compressed_data.read_unsigned_int();
-
-						Lzma context(header, unpacked_length);
-						context.decompress_stream(compressed_data, output);
-					}
+					uint8_t header[lzma::PROPS_SIZE];
+					compressed_data.read(header, lzma::PROPS_SIZE);
+					compressed_data.read_unsigned_int();
+
+					// Length is not passed for the same reason, output limit is always reached before data ends without end marker
+					Lzma decompressor(header, SIZE_MAX);
+					decompressor.set_output_callback(range_callback);
+					decompressor.set_output_limit(range_end);
+					decompressor.decompress_stream(compressed_data, chunk);
 				}
 			}
 		}
@@ -0,0 +1,174 @@
+#include "SupercellCompression/Sc/MetadataView.h"
+
+namespace sc
+{
+	namespace ScCompression
+	{
+		// Metadata tables use variable-width fields of 1, 2 or 4 bytes
+		static uint32_t read_field(const uint8_t* ptr, uint32_t field_size)
+		{
+			if (field_size > 3)
+			{
+				return *(const uint32_t*)ptr;
+			}
+			else if (field_size <= 1)
+			{
+				return *ptr;
+			}
+			else
+			{
+				return *(const uint16_t*)ptr;
+			}
+		}
+
+		MetadataView::MetadataView(const uint8_t* buffer_end, bool build_index)
+		{
+			read(buffer_end);
+
+			if (build_index)
+			{
+				m_index.reserve(m_asset_count);
+				for (uint32_t i = 0; m_asset_count > i; i++)
+				{
+					m_index.emplace(at(i).name, i);
+				}
+			}
+		}
+
+		MetadataView::MetadataView(Stream& input, bool build_index) :
+			MetadataView((const uint8_t*)input.data() + input.length(), build_index)
+		{
+		}
+
+		void MetadataView::read(const uint8_t* buffer_end)
+		{
+			const uint8_t* metadata_header = buffer_end - 6;
+
+			char metadata_flags = *(const char*)metadata_header;
+			if ((metadata_flags & 0xFC) != 0x24)
+			{
+				return;
+			}
+
+			// -- Initial Part --
+			uint8_t asset_info_field_size = *(metadata_header + 1);
+
+			const uint8_t* asset_info_offset_ptr = metadata_header - asset_info_field_size;
+			uint32_t asset_info_offset = read_field(asset_info_offset_ptr, asset_info_field_size);
+
+			// -- Second Part --
+			m_asset_info_ptr = asset_info_offset_ptr - asset_info_offset;
+
+			char strings_bits_offset = metadata_flags & 3;
+			m_info_field_size = 1ULL << (metadata_flags & 3);
+			if (m_info_field_size >= 3u)
+			{
+				int32_t strings_data_offset = 0xFFFFFFFDULL << strings_bits_offset;
+				if (m_info_field_size >= 8u)
+				{
+					const uint8_t* string_data_ptr = m_asset_info_ptr + strings_data_offset;
+
+					m_hash_info_field_size = 8;
+
+					m_strings_ptr = &m_asset_info_ptr[strings_data_offset - *(const uint32_t*)&m_asset_info_ptr[strings_data_offset]];
+					m_strings_info_field_size = *(const uint8_t*)(string_data_ptr + m_info_field_size);
+				}
+				else
+				{
+					m_hash_info_field_size = 1ULL << (metadata_flags & 3);
+
+					m_strings_info_field_size = *(const uint32_t*)&m_asset_info_ptr[strings_data_offset + m_info_field_size];
+
+					uint32_t strings_array_offset = *(const uint32_t*)(m_asset_info_ptr + strings_data_offset);
+
+					int strings_offset = strings_data_offset - strings_array_offset;
+					m_strings_ptr = m_asset_info_ptr + strings_offset;
+				}
+
+				m_asset_count = *(const uint32_t*)(m_asset_info_ptr - m_info_field_size);
+			}
+			else if (m_info_field_size > 1u)
+			{
+				m_hash_info_field_size = 1ULL << (metadata_flags & 3);
+
+				int bit_offset = 0xFFFFFFFD << strings_bits_offset;
+				const uint8_t* strings_array_data_offset = &m_asset_info_ptr[bit_offset];
+
+				m_strings_ptr = &strings_array_data_offset[-*(const uint16_t*)strings_array_data_offset];
+
+				m_strings_info_field_size = *(const uint16_t*)(strings_array_data_offset + m_info_field_size);
+
+				m_asset_count = *(const uint16_t*)(m_asset_info_ptr - m_info_field_size);
+			}
+			else
+			{
+				m_strings_ptr = &m_asset_info_ptr[-3 - m_asset_info_ptr[-3]];
+
+				m_asset_count = m_asset_info_ptr[-m_info_field_size];
+
+				m_strings_info_field_size = 1;
+				m_hash_info_field_size = 1;
+			}
+
+			if (!m_asset_count)
+			{
+				return;
+			}
+
+			// -- Last part --
+			// Here we get number of strings and hashes. For some reason, in theory, there can be a different number of them.
+			m_strings_count = read_field(m_strings_ptr - m_strings_info_field_size, m_strings_info_field_size);
+
+			// Count field has the same width as other asset info fields
+			m_hash_count = read_field(m_asset_info_ptr - m_info_field_size, m_info_field_size);
+
+			m_hash_flags_ptr = &m_asset_info_ptr[m_hash_count * m_info_field_size];
+		}
+
+		MetadataView::Asset MetadataView::at(uint32_t index) const
+		{
+			Asset asset;
+
+			if (m_strings_count > index)
+			{
+				const uint8_t* string_offset_ptr = m_strings_ptr + index * m_strings_info_field_size;
+				uint32_t string_offset = read_field(string_offset_ptr, m_strings_info_field_size);
+
+				asset.name = std::string_view((const char*)&string_offset_ptr[-(int64_t)string_offset]);
+			}
+
+			if (m_hash_count > index)
+			{
+				uint8_t hash_flag = m_hash_flags_ptr[index];
+				bool is_valid_hash = hash_flag >> 2 == 0x19 || hash_flag >> 2 == 5;
+
+				if (is_valid_hash)
+				{
+					const uint8_t* hash_offset_ptr = &m_asset_info_ptr[index * m_info_field_size];
+					uint32_t hash_offset = read_field(hash_offset_ptr, m_hash_info_field_size);
+
+					uint8_t hash_length_field_size = 1ULL << (hash_flag & 3);
+
+					const uint8_t* hash_ptr = &hash_offset_ptr[-(int64_t)hash_offset];
+
+					asset.hash = hash_ptr;
+					asset.hash_length = read_field(hash_ptr - hash_length_field_size, hash_length_field_size);
+				}
+			}
+
+			return asset;
+		}
+
+		bool MetadataView::find(std::string_view name, Asset& asset) const
+		{
+			auto it = m_index.find(name);
+			if (it == m_index.end())
+			{
+				return false;
+			}
+
+			asset = at(it->second);
+			return true;
+		}
+	}
+}
@@ -0,0 +1,174 @@
+#include "SupercellCompression/ScCompression.h"
+
+#define ZSTD_STATIC_LINKING_ONLY
+#include <zstd.h>
+#include <algorithm>
+
+#include "exception/io/BinariesExceptions.h"
+#include "SupercellCompression/exception/ScCompression.h"
+
+namespace sc {
+	namespace ScCompression
+	{
+		// Sums content size of every Zstandard frame. Frames are walked by block headers, so nothing is decompressed
+		static uint64_t zstd_unpacked_length(Stream& input, size_t data_offset, size_t data_length)
+		{
+			if (input.data() != nullptr)
+			{
+				unsigned long long content_size = ZSTD_findDecompressedSize((const uint8_t*)input.data() + data_offset, data_length);
+				if (content_size == ZSTD_CONTENTSIZE_UNKNOWN || content_size == ZSTD_CONTENTSIZE_ERROR)
+				{
+					return Info::UnknownLength;
+				}
+
+				return content_size;
+			}
+
+			uint64_t unpacked_length = 0;
+			size_t data_end = data_offset + data_length;
+			for (size_t offset = data_offset; data_end > offset;)
+			{
+				uint8_t frame_header[ZSTD_FRAMEHEADERSIZE_MAX];
+				input.seek(offset);
+				size_t frame_header_length = input.read(frame_header, std::min<size_t>(sizeof(frame_header), data_end - offset));
+
+				ZSTD_frameHeader header;
+				if (ZSTD_getFrameHeader(&header, frame_header, frame_header_length) != 0)
+				{
+					// Everything after last complete frame is not a Zstandard data
+					if (offset == data_offset) return Info::UnknownLength;
+					break;
+				}
+
+				if (header.frameType == ZSTD_skippableFrame)
+				{
+					offset += header.headerSize + header.frameContentSize;
+					continue;
+				}
+
+				if (header.frameContentSize == ZSTD_CONTENTSIZE_UNKNOWN)
+				{
+					return Info::UnknownLength;
+				}
+
+				unpacked_length += header.frameContentSize;
+				offset += header.headerSize;
+
+				// 3 bytes block header: last block flag, 2 bits of block type and 21 bits of block size
+				const size_t block_header_size = 3;
+				bool last_block = false;
+				while (!last_block && data_end > offset)
+				{
+					uint8_t block_header_bytes[block_header_size];
+					input.seek(offset);
+					if (input.read(block_header_bytes, block_header_size) != block_header_size)
+					{
+						return Info::UnknownLength;
+					}
+
+					uint32_t block_header = block_header_bytes[0] | (block_header_bytes[1] << 8) | (block_header_bytes[2] << 16);
+					last_block = block_header & 1;
+					uint32_t block_type = (block_header >> 1) & 3;
+					uint32_t block_size = block_header >> 3;
+
+					// RLE block stores only one byte
+					offset += block_header_size + (block_type == 1 ? 1 : block_size);
+				}
+
+				if (header.checksumFlag)
+				{
+					offset += 4;
+				}
+			}
+
+			return unpacked_length;
+		}
+
+		Info inspect(Stream& input)
+		{
+			Info info;
+
+			size_t initial_position = input.position();
+			size_t data_end = input.length();
+
+			uint16_t magic = input.read_unsigned_short(Endian::Big);
+			if (magic != SC_MAGIC)
+			{
+				input.seek(initial_position);
+				throw BadMagicException((uint8_t*)&SC_MAGIC, (uint8_t*)&magic, sizeof(uint16_t));
+			}
+
+			info.version = input.read_unsigned_int(Endian::Big);
+			if (info.version == 4)
+			{
+				info.version = input.read_unsigned_int(Endian::Big);
+
+				// Metadata is stored at the end of file: START + metadata + metadata length
+				size_t header_position = input.position();
+				input.seek(input.length() - 4);
+				info.metadata_length = input.read_unsigned_int(Endian::Big);
+				input.seek(header_position);
+
+				info.has_metadata = true;
+				info.metadata_offset = input.length() - 4 - info.metadata_length;
+
+				// metadata_length + metadata_length_bytes_size + START length
+				data_end = info.metadata_offset - 5;
+			}
+
+			uint32_t hash_length = input.read_unsigned_int(Endian::Big);
+			info.hash.resize(hash_length);
+			input.read(info.hash.data(), hash_length);
+
+			info.data_offset = input.position();
+			info.data_length = data_end - info.data_offset;
+
+			switch (info.version)
+			{
+			case 3:
+			{
+				info.signature = Signature::Zstandard;
+
+				// Data can be split into several frames, so content sizes of all frames are summed
+				info.unpacked_length = zstd_unpacked_length(input, info.data_offset, info.data_length);
+			}
+			break;
+
+			case 1:
+			{
+				uint32_t sclz_magic = input.read_unsigned_int();
+				if (sclz_magic == SCLZ_MAGIC)
+				{
+					info.signature = Signature::Lzham;
+
+					// dictionary size
+					input.read_unsigned_byte();
+					info.unpacked_length = input.read_unsigned_int();
+				}
+				else
+				{
+					info.signature = Signature::Lzma;
+
+					input.seek(info.data_offset + lzma::PROPS_SIZE);
+					uint32_t unpacked_length = input.read_unsigned_int();
+
+					// All bits set means that length is unknown and data ends with end marker
+					if (unpacked_length != UINT32_MAX)
+					{
+						info.unpacked_length = unpacked_length;
+					}
+				}
+			}
+			break;
+
+			default:
+				input.seek(initial_position);
+				throw ScUnknownVersionException();
+			}
+
+			input.seek(initial_position);
+
+			return info;
+		}
+	}
+}
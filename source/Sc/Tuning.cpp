@@ -0,0 +1,138 @@
+#include "SupercellCompression/Sc/Tuning.h"
+
+#include <algorithm>
+
+namespace sc
+{
+	namespace ScCompression
+	{
+		namespace Compressor
+		{
+			// Settings are selected from first table row which max_length is not less than input length.
+			// Rows start from fixed levels that SC compression used before tuning (LZMA 6, Zstandard 16).
+			// Setting differs from those defaults only where it meets both criteria:
+			// - output is at least 2% smaller or compression is at least 2% faster on inputs of that row;
+			// - compression is at most 25% slower and decompression is not slower.
+			// Threads are given only to inputs that are split into enough blocks to keep them busy
+
+			struct LzmaTuning
+			{
+				size_t max_length;
+				int level;
+				uint32_t min_dict_size;
+				uint32_t max_dict_size;
+				int threads;
+			};
+
+			static const LzmaTuning lzma_tuning[] =
+			{
+				// Dictionary is clamped to input length, bigger dictionary only costs memory.
+				// Match finder thread costs more than it saves on small inputs
+				{ 1 << 20, 6, 1 << 16, 1 << 20, 1 },
+				{ 1 << 24, 6, 1 << 20, 1 << 24, 2 },
+				// Level 7 only raises fast bytes from 32 to 64 since dictionary is set explicitly.
+				// It meets criteria only on inputs long enough for repeated long matches
+				{ SIZE_MAX, 7, 1 << 24, 1 << 25, 2 },
+			};
+
+			struct LzhamTuning
+			{
+				size_t max_length;
+				uint32_t max_dict_size_log2;
+				uint32_t max_helper_threads;
+			};
+
+			// Dictionary is clamped to input length like LZMA. SC container also caps it at SCLZ_DEFAULT_DICT_SIZE_LOG2
+			// unless large dictionary is allowed in context. Helper threads are only given to inputs
+			// that are split into many parse blocks, small inputs can not keep them busy
+			static const LzhamTuning lzham_tuning[] =
+			{
+				{ 1 << 20, 20, 0 },
+				{ 1 << 24, 24, 4 },
+				{ SIZE_MAX, lzham::MAX_DICT_SIZE_LOG2_X86, lzham::MAX_HELPER_THREADS },
+			};
+
+			struct ZstdTuning
+			{
+				size_t max_length;
+				int compression_level;
+				int window_log;
+				size_t job_size;
+			};
+
+			static const ZstdTuning zstd_tuning[] =
+			{
+				// Level 19 is about twice slower than level 16 at any input length, so it never meets criteria.
+				// Multithreading does not start for small inputs at all
+				{ 1 << 20, 16, 0, 0 },
+				{ 1 << 24, 16, 0, 1 << 20 },
+				// Bigger window meets ratio criterion only when input is longer than default window.
+				// Window log 24 is still within default window limit of streaming decompression
+				{ SIZE_MAX, 16, 24, 1 << 22 },
+			};
+
+			template<typename T, size_t N>
+			static const T& select_tuning(const T(&table)[N], size_t input_length)
+			{
+				for (const T& row : table)
+				{
+					if (row.max_length >= input_length)
+					{
+						return row;
+					}
+				}
+
+				return table[N - 1];
+			}
+
+			// Smallest log2 of size that can hold length
+			static uint32_t ceil_log2(size_t length)
+			{
+				uint32_t result = 0;
+				while (result < 63 && ((size_t)1 << result) < length)
+				{
+					result++;
+				}
+
+				return result;
+			}
+
+			void tune_props(sc::Compressor::Lzma::Props& props, size_t input_length, uint32_t threads_count)
+			{
+				const LzmaTuning& tuning = select_tuning(lzma_tuning, input_length);
+
+				uint32_t dict_size_log2 = ceil_log2(input_length);
+				props.dict_size = dict_size_log2 >= 32 ? tuning.max_dict_size : std::clamp<uint32_t>(1u << dict_size_log2, tuning.min_dict_size, tuning.max_dict_size);
+				props.reduce_size = input_length;
+				props.level = tuning.level;
+				props.threads = threads_count > 1 ? tuning.threads : 1;
+
+				if (input_length > 1 << 28)
+					props.lc = 4;
+			}
+
+			void tune_props(sc::Compressor::Lzham::Props& props, size_t input_length, uint32_t threads_count)
+			{
+				const LzhamTuning& tuning = select_tuning(lzham_tuning, input_length);
+
+				props.dict_size_log2 = std::clamp(ceil_log2(input_length), lzham::MIN_DICT_SIZE_LOG2, tuning.max_dict_size_log2);
+				props.max_helper_threads = static_cast<int32_t>(std::min(threads_count > 1 ? threads_count - 1 : 0, tuning.max_helper_threads));
+			}
+
+			void tune_props(sc::Compressor::Zstd::Props& props, size_t input_length, uint32_t threads_count)
+			{
+				const ZstdTuning& tuning = select_tuning(zstd_tuning, input_length);
+
+				props.compression_level = tuning.compression_level;
+				props.window_log = tuning.window_log;
+
+				// One worker per job, but no more than there are threads. Zero workers means no worker threads at all
+				size_t jobs_count = tuning.job_size ? (input_length + tuning.job_size - 1) / tuning.job_size : 0;
+				uint32_t workers_count = static_cast<uint32_t>(std::min<size_t>(jobs_count, threads_count));
+
+				props.workers_count = workers_count > 1 ? static_cast<int>(workers_count) : 0;
+				props.job_size = props.workers_count ? static_cast<int>(tuning.job_size) : 0;
+			}
+		}
+	}
+}
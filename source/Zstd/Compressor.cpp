@@ -1,10 +1,13 @@
 #include "SupercellCompression/Zstd.h"
 
+#define ZSTD_STATIC_LINKING_ONLY
 #include <zstd.h>
+#include <algorithm>
 
 #include "exception/MemoryAllocationException.h"
 #include "SupercellCompression/exception/Zstd.h"
 #include "memory/alloc.h"
+#include "io/buffer_stream.h"
 
 namespace sc
 {
@@ -36,8 +39,31 @@ namespace sc
 			ZSTD_CCtx_setParameter(m_context, ZSTD_c_jobSize, props.job_size);
 			ZSTD_CCtx_setParameter(m_context, ZSTD_c_overlapLog, props.overlap_log);
 
-			m_input_buffer = memalloc(Input_Buffer_Size);
-			m_output_buffer = memalloc(Output_Buffer_Size);
+			// Level of referenced dictionary replaces level of context,
+			// so dictionary prepared for another level is loaded as content and digested for level of context
+			if (props.dictionary && props.dictionary->compression_level() == props.compression_level)
+			{
+				ZSTD_CCtx_refCDict(m_context, props.dictionary->compress_dictionary());
+			}
+			else if (props.dictionary)
+			{
+				ZSTD_CCtx_loadDictionary_byReference(m_context, props.dictionary->data(), props.dictionary->length());
+			}
+
+			m_frame_size = props.frame_size;
+			m_write_seek_table = props.write_seek_table;
+
+			ZSTD_CCtx_setParameter(m_context, ZSTD_c_targetCBlockSize, static_cast<int>(props.target_block_size));
+
+			m_flush_size = props.flush_size;
+			m_flush_interval = std::chrono::milliseconds(props.flush_interval);
+
+			m_reference = props.reference;
+			m_reference_length = props.reference_length;
+			if (m_reference)
+			{
+				ZSTD_CCtx_setParameter(m_context, ZSTD_c_enableLongDistanceMatching, 1);
+			}
 		}
 
 		Zstd::~Zstd()
@@ -57,20 +83,89 @@ namespace sc
 
 		void Zstd::compress_stream(Stream& input, Stream& output)
 		{
-			ZSTD_CCtx_setPledgedSrcSize(m_context, input.length() - input.position());
+			size_t remain_bytes = input.length() - input.position();
+
+			// Window must cover both reference and new data that follows it, otherwise matches with reference are lost.
+			// Longer data is compressed with largest window
+			if (m_reference)
+			{
+				size_t frame_length = m_frame_size ? std::min(m_frame_size, remain_bytes) : remain_bytes;
+				size_t window_length = frame_length > SIZE_MAX - m_reference_length ? SIZE_MAX : m_reference_length + frame_length;
+				ZSTD_bounds bounds = ZSTD_cParam_getBounds(ZSTD_c_windowLog);
+
+				int window_log = bounds.lowerBound;
+				while (window_log < ZSTD_WINDOWLOG_MAX && ((size_t)1 << window_log) < window_length)
+				{
+					window_log++;
+				}
+
+				ZSTD_CCtx_setParameter(m_context, ZSTD_c_windowLog, window_log);
+			}
+
+			if (m_frame_size == 0)
+			{
+				compress_frame(input, output, remain_bytes);
+				return;
+			}
+
+			std::vector<uint32_t> compressed_sizes;
+			std::vector<uint32_t> decompressed_sizes;
+
+			do
+			{
+				size_t frame_length = std::min(m_frame_size, remain_bytes);
+
+				compressed_sizes.push_back(static_cast<uint32_t>(compress_frame(input, output, frame_length)));
+				decompressed_sizes.push_back(static_cast<uint32_t>(frame_length));
+
+				remain_bytes -= frame_length;
+			} while (remain_bytes);
+
+			if (m_write_seek_table)
+			{
+				write_seek_table(output, compressed_sizes, decompressed_sizes);
+			}
+		}
 
-			size_t remain_bytes = Input_Buffer_Size;
+		size_t Zstd::compress_frame(Stream& input, Stream& output, size_t length)
+		{
+			// Prefix is used only for one frame
+			if (m_reference)
+			{
+				ZSTD_CCtx_refPrefix(m_context, m_reference, m_reference_length);
+			}
+
+			if (input.data() != nullptr)
+			{
+				return compress_frame_memory(input, output, length);
+			}
+
+			// Stream buffers are allocated only when input has to be read in chunks
+			if (!m_input_buffer) m_input_buffer = memalloc(Input_Buffer_Size);
+			if (!m_output_buffer) m_output_buffer = memalloc(Output_Buffer_Size);
+
+			ZSTD_CCtx_setPledgedSrcSize(m_context, length);
+
+			size_t compressed_length = 0;
+			size_t remain_bytes = length;
 			while (true) {
-				size_t byteCount = input.read(m_input_buffer, remain_bytes);
+				size_t byteCount = read_input(input, m_input_buffer, std::min(Input_Buffer_Size, remain_bytes));
+				remain_bytes -= byteCount;
 
-				const int last_chunk = (byteCount < remain_bytes);
+				const int last_chunk = (remain_bytes == 0 || byteCount == 0);
 				const ZSTD_EndDirective mode = last_chunk ? ZSTD_e_end : ZSTD_e_continue;
 				ZSTD_inBuffer input_buffer = { m_input_buffer, byteCount, 0 };
 				int finished = 0;
 				while (!finished) {
 					ZSTD_outBuffer output_buffer = { m_output_buffer, Output_Buffer_Size, 0 };
 					size_t const remaining = ZSTD_compressStream2(m_context, &output_buffer, &input_buffer, mode);
+					if (ZSTD_isError(remaining))
+					{
+						throw ZstdCompressException();
+					}
+
 					output.write(m_output_buffer, output_buffer.pos);
+					compressed_length += output_buffer.pos;
 					finished = last_chunk ? (remaining == 0) : (input_buffer.pos == input_buffer.size);
 				};
 				if (input_buffer.pos != input_buffer.size)
@@ -82,6 +177,163 @@ namespace sc
 					break;
 				}
 			}
+
+			return compressed_length;
+		}
+
+		size_t Zstd::compress_frame_memory(Stream& input, Stream& output, size_t length)
+		{
+			const uint8_t* source = (const uint8_t*)input.data() + input.position();
+			input.seek(length, Seek::Add);
+
+			if (m_input_callback && length)
+			{
+				m_input_callback(source, length);
+			}
+
+			// Buffer output is enlarged to compress bound, so frame is compressed with a single call right into it
+			BufferStream* buffer = dynamic_cast<BufferStream*>(&output);
+			if (buffer)
+			{
+				size_t position = buffer->position();
+				size_t buffer_length = buffer->length();
+				size_t bound = ZSTD_compressBound(length);
+
+				if (position + bound > buffer_length)
+				{
+					buffer->resize(position + bound);
+				}
+
+				size_t result = ZSTD_compress2(m_context, (uint8_t*)buffer->data() + position, bound, source, length);
+				if (ZSTD_isError(result))
+				{
+					throw ZstdCompressException();
+				}
+
+				buffer->resize(std::max(buffer_length, position + result));
+				buffer->seek(position + result);
+
+				return result;
+			}
+
+			// Otherwise input is still taken without copying and only output goes through buffer
+			if (!m_output_buffer) m_output_buffer = memalloc(Output_Buffer_Size);
+
+			ZSTD_CCtx_setPledgedSrcSize(m_context, length);
+
+			size_t compressed_length = 0;
+			ZSTD_inBuffer input_buffer = { source, length, 0 };
+			size_t remaining = 0;
+			do
+			{
+				ZSTD_outBuffer output_buffer = { m_output_buffer, Output_Buffer_Size, 0 };
+				remaining = ZSTD_compressStream2(m_context, &output_buffer, &input_buffer, ZSTD_e_end);
+				if (ZSTD_isError(remaining))
+				{
+					throw ZstdCompressException();
+				}
+
+				output.write(m_output_buffer, output_buffer.pos);
+				compressed_length += output_buffer.pos;
+			} while (remaining != 0);
+
+			return compressed_length;
+		}
+
+		void Zstd::compress_chunk(Stream& output, const uint8_t* data, size_t length)
+		{
+			using namespace std::chrono;
+
+			if (m_input_callback && length)
+			{
+				m_input_callback(data, length);
+			}
+
+			// Frame is started before thresholds are checked, so first chunk is measured from frame start
+			start_live_frame();
+
+			m_unflushed_length += length;
+
+			bool flush_by_size = m_flush_size && m_unflushed_length >= m_flush_size;
+			bool flush_by_time = m_flush_interval.count() && steady_clock::now() - m_last_flush >= m_flush_interval;
+
+			compress_live(output, data, length, flush_by_size || flush_by_time ? ZSTD_e_flush : ZSTD_e_continue);
+		}
+
+		void Zstd::flush(Stream& output)
+		{
+			compress_live(output, nullptr, 0, ZSTD_e_flush);
+		}
+
+		void Zstd::end(Stream& output)
+		{
+			compress_live(output, nullptr, 0, ZSTD_e_end);
+			m_live_frame = false;
+		}
+
+		void Zstd::start_live_frame()
+		{
+			if (m_live_frame) return;
+
+			if (m_reference)
+			{
+				ZSTD_CCtx_refPrefix(m_context, m_reference, m_reference_length);
+			}
+
+			m_live_frame = true;
+			m_last_flush = std::chrono::steady_clock::now();
+		}
+
+		void Zstd::compress_live(Stream& output, const uint8_t* data, size_t length, int directive)
+		{
+			ZSTD_EndDirective mode = static_cast<ZSTD_EndDirective>(directive);
+
+			start_live_frame();
+
+			if (!m_output_buffer) m_output_buffer = memalloc(Output_Buffer_Size);
+
+			// Flush and end directives are finished only when compressor returns zero
+			ZSTD_inBuffer input_buffer = { data, length, 0 };
+			size_t remaining = 0;
+			do
+			{
+				ZSTD_outBuffer output_buffer = { m_output_buffer, Output_Buffer_Size, 0 };
+				remaining = ZSTD_compressStream2(m_context, &output_buffer, &input_buffer, mode);
+				if (ZSTD_isError(remaining))
+				{
+					throw ZstdCompressException();
+				}
+
+				output.write(m_output_buffer, output_buffer.pos);
+			} while (mode == ZSTD_e_continue ? input_buffer.pos != input_buffer.size : remaining != 0);
+
+			if (mode != ZSTD_e_continue)
+			{
+				m_unflushed_length = 0;
+				m_last_flush = std::chrono::steady_clock::now();
+			}
+		}
+
+		void Zstd::write_seek_table(Stream& output, const std::vector<uint32_t>& compressed_sizes, const std::vector<uint32_t>& decompressed_sizes)
+		{
+			uint32_t frames_count = static_cast<uint32_t>(compressed_sizes.size());
+
+			output.write_unsigned_int(zstd::SKIPPABLE_FRAME_MAGIC);
+			output.write_unsigned_int(frames_count * zstd::SEEK_TABLE_ENTRY_SIZE + zstd::SEEK_TABLE_FOOTER_SIZE);
+
+			for (uint32_t i = 0; frames_count > i; i++)
+			{
+				output.write_unsigned_int(compressed_sizes[i]);
+				output.write_unsigned_int(decompressed_sizes[i]);
+			}
+
+			// Footer
+			output.write_unsigned_int(frames_count);
+
+			// Seek table descriptor. Frame checksums are not stored
+			output.write_unsigned_byte(0);
+
+			output.write_unsigned_int(zstd::SEEKABLE_MAGIC);
 		}
 	}
 }
\ No newline at end of file
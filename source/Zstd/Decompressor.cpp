@@ -1,11 +1,17 @@
 #include "SupercellCompression/Zstd.h"
 
 #include <zstd.h>
+#include <zstd_errors.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
 
 #include "exception/MemoryAllocationException.h"
 #include "SupercellCompression/exception/Zstd.h"
 #include "memory/alloc.h"
 
+#include "../Parallel.h"
+
 namespace sc
 {
 	namespace Decompressor
@@ -24,27 +30,179 @@ namespace sc
 				ZSTD_freeDStream(m_context);
 				throw ZstdDecompressInitException();
 			}
+		}
+
+		Zstd::Zstd(Props& props) : Zstd()
+		{
+			m_threads_count = props.threads_count;
+			m_dictionary = props.dictionary;
+
+			if (m_dictionary)
+			{
+				ZSTD_DCtx_refDDict(m_context, m_dictionary->decompress_dictionary());
+			}
 
-			m_input_buffer = memalloc(Input_Buffer_Size);
-			m_output_buffer = memalloc(Output_Buffer_Size);
+			m_reference = props.reference;
+			m_reference_length = props.reference_length;
+			if (m_reference)
+			{
+				// Delta frames have window that covers whole reference
+				ZSTD_DCtx_setParameter(m_context, ZSTD_d_windowLogMax, ZSTD_dParam_getBounds(ZSTD_d_windowLogMax).upperBound);
+			}
+		}
+
+		void Zstd::prepare_frame(ZSTD_DCtx* context) const
+		{
+			if (m_reference)
+			{
+				ZSTD_DCtx_refPrefix(context, m_reference, m_reference_length);
+			}
 		}
 
 		void Zstd::decompress_stream(Stream& input, Stream& output)
 		{
-			uint64_t unpacked_size = UINT64_MAX;
+			// Data in memory is decompressed frame by frame with single calls
+			if (input.data() != nullptr)
+			{
+				if (decompress_frames(input, output))
+				{
+					return;
+				}
+			}
+
+			decompress_stream_range(input, output, 0, SIZE_MAX, input.length() - input.position());
+		}
+
+		void Zstd::decompress_range(Stream& input, Stream& output, size_t offset, size_t length, size_t input_length)
+		{
+			input_length = std::min(input_length, input.length() - input.position());
+			size_t input_end = input.position() + input_length;
 
+			std::vector<FrameEntry> frames;
+			if (!read_seek_table(input, input_length, frames))
 			{
-				size_t position = input.position();
-				uint8_t frame_header[18];
-				input.read(frame_header, sizeof(frame_header));
-				unpacked_size = ZSTD_getFrameContentSize(&frame_header, sizeof(frame_header));
+				decompress_stream_range(input, output, offset, length, input_length);
+				return;
+			}
+
+			size_t range_end = length > SIZE_MAX - offset ? SIZE_MAX : offset + length;
 
-				if (unpacked_size == ZSTD_CONTENTSIZE_ERROR)
+			std::vector<uint8_t> compressed_buffer;
+			std::vector<uint8_t> unpacked_buffer;
+
+			for (const FrameEntry& frame : frames)
+			{
+				size_t frame_end = frame.unpacked_offset + frame.unpacked_length;
+				if (offset >= frame_end) continue;
+				if (frame.unpacked_offset >= range_end) break;
+
+				const uint8_t* compressed_data = nullptr;
+				if (input.data() != nullptr)
+				{
+					compressed_data = (const uint8_t*)input.data() + frame.offset;
+				}
+				else
+				{
+					compressed_buffer.resize(frame.length);
+					input.seek(frame.offset);
+					if (input.read(compressed_buffer.data(), frame.length) != frame.length)
+					{
+						throw ZstdCorruptedDecompressException();
+					}
+
+					compressed_data = compressed_buffer.data();
+				}
+
+				unpacked_buffer.resize(frame.unpacked_length);
+				prepare_frame(m_context);
+				size_t result = ZSTD_decompressDCtx(m_context, unpacked_buffer.data(), frame.unpacked_length, compressed_data, frame.length);
+				if (ZSTD_isError(result) || result != frame.unpacked_length)
 				{
-					unpacked_size = UINT64_MAX;
+					throw ZstdCorruptedDecompressException();
 				}
 
+				size_t begin = std::max(offset, frame.unpacked_offset) - frame.unpacked_offset;
+				size_t end = std::min(range_end, frame_end) - frame.unpacked_offset;
+				write_output(output, unpacked_buffer.data() + begin, end - begin);
+			}
+
+			input.seek(input_end);
+		}
+
+		bool Zstd::decompress_chunk(Stream& output, const uint8_t* data, size_t length)
+		{
+			if (!m_output_buffer) m_output_buffer = memalloc(Output_Buffer_Size);
+
+			if (!m_live_frame)
+			{
+				ZSTD_DCtx_reset(m_context, ZSTD_reset_session_only);
+				prepare_frame(m_context);
+				m_live_frame = true;
+			}
+
+			ZSTD_inBuffer input_buffer = { data, length, 0 };
+
+			// Output buffer filled to the end means that decompressor may have more data to flush
+			bool frame_finished = false;
+			bool output_full = false;
+			do
+			{
+				ZSTD_outBuffer output_buffer = { m_output_buffer, Output_Buffer_Size, 0 };
+				size_t result = ZSTD_decompressStream(m_context, &output_buffer, &input_buffer);
+				if (ZSTD_isError(result))
+				{
+					m_live_frame = false;
+					throw ZstdCorruptedDecompressException();
+				}
+
+				write_output(output, m_output_buffer, output_buffer.pos);
+				output_full = output_buffer.pos == output_buffer.size;
+
+				// Next frame can start in the same chunk
+				frame_finished = result == 0;
+				if (frame_finished && m_reference)
+				{
+					ZSTD_DCtx_reset(m_context, ZSTD_reset_session_only);
+					prepare_frame(m_context);
+				}
+			} while (input_buffer.pos < input_buffer.size || output_full);
+
+			return frame_finished;
+		}
+
+		void Zstd::decompress_stream_range(Stream& input, Stream& output, size_t offset, size_t length, size_t input_length)
+		{
+			ZSTD_DCtx_reset(m_context, ZSTD_reset_session_only);
+			prepare_frame(m_context);
+
+			// Stream buffers are allocated only when data has to be read in chunks
+			if (!m_input_buffer) m_input_buffer = memalloc(Input_Buffer_Size);
+			if (!m_output_buffer) m_output_buffer = memalloc(Output_Buffer_Size);
+
+			size_t range_end = length > SIZE_MAX - offset ? SIZE_MAX : offset + length;
+
+			// Position of decompressed chunk in whole decompressed data
+			size_t unpacked_position = 0;
+
+			// If whole data is requested and first frame stores its content size, frame is decompressed right into output memory
+			uint8_t* destination = nullptr;
+			if (offset == 0 && range_end == SIZE_MAX)
+			{
+				size_t position = input.position();
+				uint8_t header[18];
+				size_t header_length = input.read(header, std::min(sizeof(header), input_length));
 				input.seek(position);
+
+				unsigned long long content_size = ZSTD_getFrameContentSize(header, header_length);
+				if (content_size != ZSTD_CONTENTSIZE_ERROR && content_size != ZSTD_CONTENTSIZE_UNKNOWN && content_size <= SIZE_MAX)
+				{
+					destination = reserve_output(output, static_cast<size_t>(content_size), input_length);
+				}
+
+				if (destination)
+				{
+					unpacked_position = static_cast<size_t>(content_size);
+				}
 			}
 
 			ZSTD_inBuffer input_buffer;
@@ -52,43 +210,314 @@ namespace sc
 			input_buffer.size = Input_Buffer_Size;
 
 			ZSTD_outBuffer output_buffer;
-			output_buffer.dst = m_output_buffer;
-			output_buffer.size = Output_Buffer_Size;
+			if (destination)
+			{
+				output_buffer.dst = destination;
+				output_buffer.size = unpacked_position;
+				output_buffer.pos = 0;
+			}
+			else
+			{
+				output_buffer.dst = m_output_buffer;
+				output_buffer.size = Output_Buffer_Size;
+			}
 
+			// Data can contain several concatenated frames, so decompression goes until input is over
+			bool frame_finished = false;
 			size_t chunk_size = 0;
-			size_t total_size = 0;
-
-			while (total_size < unpacked_size)
+			while ((chunk_size = input.read(m_input_buffer, std::min(Input_Buffer_Size, input_length))) != 0)
 			{
-				chunk_size = input.read(m_input_buffer, Input_Buffer_Size);
-				if (!chunk_size) {
-					if (unpacked_size > total_size)
-					{
-						throw ZstdCorruptedDecompressException();
-					}
-
-					break;
-				}
+				input_length -= chunk_size;
 
 				input_buffer.size = chunk_size;
 				input_buffer.pos = 0;
 
-				while (input_buffer.pos < input_buffer.size && total_size < unpacked_size)
+				while (input_buffer.pos < input_buffer.size)
 				{
+					if (destination)
+					{
+						size_t input_position = input_buffer.pos;
+						size_t output_position = output_buffer.pos;
+
+						size_t result = ZSTD_decompressStream(m_context, &output_buffer, &input_buffer);
+
+						// Frame can not produce more data than its header says
+						if (ZSTD_isError(result) || (input_position == input_buffer.pos && output_position == output_buffer.pos))
+						{
+							throw ZstdCorruptedDecompressException();
+						}
+
+						if (result == 0)
+						{
+							if (output_buffer.pos != output_buffer.size)
+							{
+								throw ZstdCorruptedDecompressException();
+							}
+
+							if (m_reference)
+							{
+								ZSTD_DCtx_reset(m_context, ZSTD_reset_session_only);
+								prepare_frame(m_context);
+							}
+
+							commit_output(output, destination, output_buffer.size);
+							destination = nullptr;
+
+							output_buffer.dst = m_output_buffer;
+							output_buffer.size = Output_Buffer_Size;
+							frame_finished = true;
+						}
+
+						continue;
+					}
+
 					output_buffer.pos = 0;
 
 					size_t result = ZSTD_decompressStream(m_context, &output_buffer, &input_buffer);
 
 					if (ZSTD_isError(result)) {
+						// Everything after last complete frame is not a Zstandard data, so just ignore it
+						if (frame_finished && ZSTD_getErrorCode(result) == ZSTD_error_prefix_unknown)
+						{
+							return;
+						}
+
 						throw ZstdCorruptedDecompressException();
 					}
 
-					output.write(m_output_buffer, output_buffer.pos);
-					total_size += output_buffer.pos;
+					size_t chunk_end = unpacked_position + output_buffer.pos;
+					if (chunk_end > offset && range_end > unpacked_position)
+					{
+						size_t begin = std::max(offset, unpacked_position) - unpacked_position;
+						size_t end = std::min(range_end, chunk_end) - unpacked_position;
+						write_output(output, m_output_buffer + begin, end - begin);
+					}
+					unpacked_position = chunk_end;
+
+					frame_finished = result == 0;
 
-					if (result == 0) break;
+					if (frame_finished && m_reference)
+					{
+						ZSTD_DCtx_reset(m_context, ZSTD_reset_session_only);
+						prepare_frame(m_context);
+					}
+
+					if (unpacked_position >= range_end)
+					{
+						return;
+					}
+				}
+			}
+
+			if (!frame_finished)
+			{
+				throw ZstdCorruptedDecompressException();
+			}
+		}
+
+		bool Zstd::decompress_frames(Stream& input, Stream& output)
+		{
+			struct Frame
+			{
+				const uint8_t* data;
+				size_t length;
+
+				size_t unpacked_offset;
+				size_t unpacked_length;
+			};
+
+			const uint8_t* data = (const uint8_t*)input.data() + input.position();
+			size_t data_length = input.length() - input.position();
+
+			std::vector<Frame> frames;
+			size_t unpacked_length = 0;
+
+			// Frame sizes are taken from frame headers. Skippable frames (like seek table) have zero content size
+			for (size_t offset = 0; data_length > offset;)
+			{
+				const uint8_t* frame_data = data + offset;
+				size_t frame_length = ZSTD_findFrameCompressedSize(frame_data, data_length - offset);
+				unsigned long long content_size = ZSTD_getFrameContentSize(frame_data, data_length - offset);
+
+				if (ZSTD_isError(frame_length) ||
+					content_size == ZSTD_CONTENTSIZE_ERROR ||
+					content_size == ZSTD_CONTENTSIZE_UNKNOWN)
+				{
+					return false;
+				}
+
+				if (content_size > SIZE_MAX - unpacked_length)
+				{
+					return false;
+				}
+
+				if (content_size)
+				{
+					frames.push_back({ frame_data, frame_length, unpacked_length, static_cast<size_t>(content_size) });
+					unpacked_length += static_cast<size_t>(content_size);
+				}
+
+				offset += frame_length;
+			}
+
+			// Too big lengths from headers are decompressed by streaming that grows output with real data
+			if (frames.empty() || !can_reserve(unpacked_length, data_length))
+			{
+				return false;
+			}
+
+			uint32_t threads_count = static_cast<uint32_t>(std::min<size_t>(m_threads_count, frames.size()));
+
+			// Frames are decompressed right into output if it can provide memory for them.
+			// Single thread has no gain from temporary buffer, so streaming decompression is used instead
+			uint8_t* unpacked_buffer = nullptr;
+			uint8_t* destination = reserve_output(output, unpacked_length, data_length);
+			if (!destination)
+			{
+				if (threads_count <= 1)
+				{
+					return false;
+				}
+
+				unpacked_buffer = memalloc(unpacked_length);
+				destination = unpacked_buffer;
+			}
+
+			std::atomic<size_t> next_frame{ 0 };
+			std::atomic<bool> failed{ false };
+
+			parallel_run(threads_count, [&](uint32_t)
+				{
+					// Single thread uses decompressor's own context
+					ZSTD_DCtx* context = threads_count > 1 ? ZSTD_createDCtx() : m_context;
+					if (!context)
+					{
+						failed = true;
+						return;
+					}
+
+					if (context != m_context && m_dictionary)
+					{
+						ZSTD_DCtx_refDDict(context, m_dictionary->decompress_dictionary());
+					}
+
+					if (context != m_context && m_reference)
+					{
+						ZSTD_DCtx_setParameter(context, ZSTD_d_windowLogMax, ZSTD_dParam_getBounds(ZSTD_d_windowLogMax).upperBound);
+					}
+
+					size_t frame_index;
+					while (!failed && (frame_index = next_frame++) < frames.size())
+					{
+						const Frame& frame = frames[frame_index];
+
+						prepare_frame(context);
+						size_t result = ZSTD_decompressDCtx(
+							context,
+							destination + frame.unpacked_offset, frame.unpacked_length,
+							frame.data, frame.length
+						);
+
+						if (ZSTD_isError(result) || result != frame.unpacked_length)
+						{
+							failed = true;
+						}
+					}
+
+					if (context != m_context)
+					{
+						ZSTD_freeDCtx(context);
+					}
+				}
+			);
+
+			if (failed)
+			{
+				if (unpacked_buffer) free(unpacked_buffer);
+				throw ZstdCorruptedDecompressException();
+			}
+
+			if (unpacked_buffer)
+			{
+				write_output(output, unpacked_buffer, unpacked_length);
+				free(unpacked_buffer);
+			}
+			else
+			{
+				commit_output(output, destination, unpacked_length);
+			}
+
+			input.seek(input.length());
+
+			return true;
+		}
+
+		bool Zstd::read_seek_table(Stream& input, size_t data_length, std::vector<FrameEntry>& frames)
+		{
+			size_t position = input.position();
+			size_t data_end = position + data_length;
+
+			if (zstd::SKIPPABLE_FRAME_HEADER_SIZE + zstd::SEEK_TABLE_FOOTER_SIZE > data_length)
+			{
+				return false;
+			}
+
+			input.seek(data_end - zstd::SEEK_TABLE_FOOTER_SIZE);
+			uint32_t frames_count = input.read_unsigned_int();
+			uint8_t descriptor = input.read_unsigned_byte();
+			uint32_t magic = input.read_unsigned_int();
+
+			// Highest bit of descriptor means that every entry also has frame checksum
+			size_t entry_size = zstd::SEEK_TABLE_ENTRY_SIZE + (descriptor & 0x80 ? 4 : 0);
+			size_t table_length = frames_count * entry_size + zstd::SEEK_TABLE_FOOTER_SIZE;
+
+			if (magic != zstd::SEEKABLE_MAGIC || table_length + zstd::SKIPPABLE_FRAME_HEADER_SIZE > data_length)
+			{
+				input.seek(position);
+				return false;
+			}
+
+			input.seek(data_end - table_length);
+
+			// Frames must fill all data before seek table, so frame offsets never point outside of input
+			size_t frames_length = data_length - table_length - zstd::SKIPPABLE_FRAME_HEADER_SIZE;
+
+			frames.resize(frames_count);
+			size_t offset = position;
+			size_t unpacked_offset = 0;
+			bool is_valid = true;
+			for (FrameEntry& frame : frames)
+			{
+				frame.offset = offset;
+				frame.length = input.read_unsigned_int();
+				frame.unpacked_offset = unpacked_offset;
+				frame.unpacked_length = input.read_unsigned_int();
+
+				if (entry_size > zstd::SEEK_TABLE_ENTRY_SIZE)
+				{
+					input.seek(entry_size - zstd::SEEK_TABLE_ENTRY_SIZE, Seek::Add);
+				}
+
+				// Frame buffers are allocated from table lengths, so table with too big lengths is ignored and data is streamed
+				if (frame.length > frames_length - (offset - position) || !can_reserve(frame.unpacked_length, frame.length))
+				{
+					is_valid = false;
+					break;
 				}
+
+				offset += frame.length;
+				unpacked_offset += frame.unpacked_length;
+			}
+
+			input.seek(position);
+
+			if (!is_valid || offset - position != frames_length)
+			{
+				frames.clear();
+				return false;
 			}
+
+			return true;
 		}
 
 		Zstd::~Zstd()
@@ -105,4 +534,4 @@ namespace sc
 			}
 		}
 	}
-}
\ No newline at end of file
+}
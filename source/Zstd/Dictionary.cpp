@@ -0,0 +1,65 @@
+#include "SupercellCompression/Zstd.h"
+
+#include <zstd.h>
+#include <zdict.h>
+
+#include "SupercellCompression/exception/Zstd.h"
+
+namespace sc
+{
+	namespace zstd
+	{
+		std::vector<uint8_t> train_dictionary(const std::vector<std::vector<uint8_t>>& samples, size_t capacity)
+		{
+			// Trainer takes all samples as one buffer with array of their sizes
+			std::vector<uint8_t> samples_buffer;
+			std::vector<size_t> samples_sizes;
+			samples_sizes.reserve(samples.size());
+
+			for (const std::vector<uint8_t>& sample : samples)
+			{
+				samples_buffer.insert(samples_buffer.end(), sample.begin(), sample.end());
+				samples_sizes.push_back(sample.size());
+			}
+
+			std::vector<uint8_t> dictionary(capacity);
+			size_t result = ZDICT_trainFromBuffer(
+				dictionary.data(), dictionary.size(),
+				samples_buffer.data(), samples_sizes.data(), static_cast<unsigned>(samples_sizes.size())
+			);
+
+			if (ZDICT_isError(result))
+			{
+				throw ZstdDictionaryTrainException();
+			}
+
+			dictionary.resize(result);
+			return dictionary;
+		}
+
+		Dictionary::Dictionary(const uint8_t* data, size_t length, int compression_level) :
+			m_content(data, data + length), m_compression_level(compression_level)
+		{
+			m_compress_dictionary = ZSTD_createCDict(data, length, compression_level);
+			m_decompress_dictionary = ZSTD_createDDict(data, length);
+
+			if (!m_compress_dictionary || !m_decompress_dictionary)
+			{
+				ZSTD_freeCDict(m_compress_dictionary);
+				ZSTD_freeDDict(m_decompress_dictionary);
+				throw ZstdDictionaryLoadException();
+			}
+		}
+
+		Dictionary::~Dictionary()
+		{
+			ZSTD_freeCDict(m_compress_dictionary);
+			ZSTD_freeDDict(m_decompress_dictionary);
+		}
+
+		uint32_t Dictionary::id() const
+		{
+			return ZSTD_getDictID_fromDDict(m_decompress_dictionary);
+		}
+	}
+}
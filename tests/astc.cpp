@@ -0,0 +1,400 @@
+#include "test.h"
+
+#include "SupercellCompression/Astc.h"
+#include "io/buffer_stream.h"
+#include "io/memory_stream.h"
+
+#include <string.h>
+
+using sc::BufferStream;
+using sc::MemoryStream;
+using sc::Stream;
+using sc::Image;
+
+static const uint16_t Width = 70;
+static const uint16_t Height = 45;
+static const size_t Pixel_Size = 4;
+
+static bool stream_equals(Stream& a, Stream& b)
+{
+	return a.length() == b.length() && (a.length() == 0 || memcmp(a.data(), b.data(), a.length()) == 0);
+}
+
+// Compresses RGBA image to raw blocks without header
+static void compress_astc(std::vector<uint8_t>& image, uint8_t blocks, uint32_t threads_count, BufferStream& output)
+{
+	sc::Compressor::Astc::Props props;
+	props.quality = sc::astc::Quality::Fastest;
+	props.blocks_x = blocks;
+	props.blocks_y = blocks;
+	props.threads_count = threads_count;
+
+	MemoryStream input(image.data(), image.size());
+	sc::Compressor::Astc compressor(props);
+	compressor.compress_image(Width, Height, Image::BasePixelType::RGBA, input, output);
+	output.seek(0);
+}
+
+static sc::Decompressor::Astc::Props decompressor_props(uint8_t blocks, uint32_t threads_count)
+{
+	sc::Decompressor::Astc::Props props;
+	props.blocks_x = blocks;
+	props.blocks_y = blocks;
+	props.threads_count = threads_count;
+	return props;
+}
+
+static void decompress_astc(BufferStream& blocks_data, uint8_t blocks, BufferStream& output)
+{
+	sc::Decompressor::Astc::Props props = decompressor_props(blocks, 1);
+	sc::Decompressor::Astc decompressor(props);
+
+	blocks_data.seek(0);
+	decompressor.decompress_image(Width, Height, Image::BasePixelType::RGBA, blocks_data, output);
+}
+
+SC_TEST(astc_threads)
+{
+	std::vector<uint8_t> image = sc::test::make_data((size_t)Width * Height * Pixel_Size);
+
+	// Every block is encoded and decoded independently, so result does not depend on number of threads
+	BufferStream single_compressed;
+	compress_astc(image, 4, 1, single_compressed);
+	BufferStream single_decompressed;
+	decompress_astc(single_compressed, 4, single_decompressed);
+	SC_CHECK(single_decompressed.length() == image.size());
+
+	BufferStream compressed;
+	compress_astc(image, 4, 4, compressed);
+	SC_CHECK(stream_equals(compressed, single_compressed));
+
+	sc::Decompressor::Astc::Props props = decompressor_props(4, 4);
+	sc::Decompressor::Astc decompressor(props);
+	BufferStream decompressed;
+	compressed.seek(0);
+	decompressor.decompress_image(Width, Height, Image::BasePixelType::RGBA, compressed, decompressed);
+	SC_CHECK(stream_equals(decompressed, single_decompressed));
+}
+
+SC_TEST(astc_reuse_threads)
+{
+	sc::Compressor::Astc::Props compressor_props;
+	compressor_props.quality = sc::astc::Quality::Fastest;
+	compressor_props.threads_count = 4;
+	sc::Compressor::Astc compressor(compressor_props);
+
+	sc::Decompressor::Astc::Props props = decompressor_props(4, 4);
+	sc::Decompressor::Astc decompressor(props);
+
+	// Same threads process every image, results match new single threaded instances
+	for (uint32_t seed = 1; 4 > seed; seed++)
+	{
+		std::vector<uint8_t> image = sc::test::make_data((size_t)Width * Height * Pixel_Size, seed);
+
+		BufferStream expected_blocks;
+		compress_astc(image, 4, 1, expected_blocks);
+		BufferStream expected_pixels;
+		decompress_astc(expected_blocks, 4, expected_pixels);
+
+		MemoryStream input(image.data(), image.size());
+		BufferStream blocks;
+		compressor.compress_image(Width, Height, Image::BasePixelType::RGBA, input, blocks);
+		SC_CHECK(stream_equals(blocks, expected_blocks));
+
+		blocks.seek(0);
+		BufferStream pixels;
+		decompressor.decompress_image(Width, Height, Image::BasePixelType::RGBA, blocks, pixels);
+		SC_CHECK(stream_equals(pixels, expected_pixels));
+	}
+}
+
+SC_TEST(astc_batch_matches_image)
+{
+	std::vector<uint8_t> first = sc::test::make_data((size_t)Width * Height * Pixel_Size, 1);
+	std::vector<uint8_t> second = sc::test::make_data((size_t)Width * Height * Pixel_Size, 2);
+
+	BufferStream first_expected;
+	compress_astc(first, 4, 1, first_expected);
+	BufferStream second_expected;
+	compress_astc(second, 6, 1, second_expected);
+
+	// Images with different block sizes share one queue of jobs of single block row
+	sc::Compressor::AstcBatch::Props props;
+	props.quality = sc::astc::Quality::Fastest;
+	props.threads_count = 4;
+	props.job_block_rows = 1;
+
+	BufferStream first_output;
+	BufferStream second_output;
+	std::vector<sc::Compressor::AstcBatch::Entry> entries(2);
+	entries[0].width = Width;
+	entries[0].height = Height;
+	entries[0].data = first.data();
+	entries[0].output = &first_output;
+	entries[1].width = Width;
+	entries[1].height = Height;
+	entries[1].data = second.data();
+	entries[1].blocks_x = 6;
+	entries[1].blocks_y = 6;
+	entries[1].output = &second_output;
+
+	sc::Compressor::AstcBatch compressor(props);
+	compressor.compress(entries);
+
+	SC_CHECK(stream_equals(first_output, first_expected));
+	SC_CHECK(stream_equals(second_output, second_expected));
+}
+
+SC_TEST(astc_region_matches_image)
+{
+	std::vector<uint8_t> image = sc::test::make_data((size_t)Width * Height * Pixel_Size);
+
+	const uint8_t block_sizes[] = { 4, 6 };
+	for (uint8_t blocks : block_sizes)
+	{
+		BufferStream compressed;
+		compress_astc(image, blocks, 1, compressed);
+		BufferStream expected;
+		decompress_astc(compressed, blocks, expected);
+		const uint8_t* expected_data = (const uint8_t*)expected.data();
+
+		sc::Decompressor::Astc::Props props = decompressor_props(blocks, 2);
+		sc::Decompressor::Astc decompressor(props);
+
+		// Whole image, rectangle inside blocks, rectangle across block borders and last pixel
+		const uint16_t regions[][4] = {
+			{ 0, 0, Width, Height },
+			{ 1, 1, 2, 2 },
+			{ 5, 3, 17, 30 },
+			{ Width - 1, Height - 1, 1, 1 },
+		};
+
+		for (const uint16_t* region : regions)
+		{
+			uint16_t x = region[0], y = region[1], region_width = region[2], region_height = region[3];
+			size_t row_length = region_width * Pixel_Size;
+
+			// Tight rows and rows with padding between them
+			const size_t strides[] = { 0, row_length + 12 };
+			for (size_t stride : strides)
+			{
+				size_t destination_stride = stride == 0 ? row_length : stride;
+				std::vector<uint8_t> destination(destination_stride * region_height, 0xCD);
+
+				compressed.seek(0);
+				decompressor.decompress_region(
+					Width, Height, Image::BasePixelType::RGBA, compressed,
+					x, y, region_width, region_height,
+					destination.data(), stride
+				);
+
+				for (uint16_t row = 0; region_height > row; row++)
+				{
+					const uint8_t* expected_row = expected_data + ((size_t)(y + row) * Width + x) * Pixel_Size;
+					const uint8_t* row_data = destination.data() + row * destination_stride;
+					SC_CHECK(memcmp(row_data, expected_row, row_length) == 0);
+
+					// Padding is not touched
+					for (size_t i = row_length; destination_stride > i; i++)
+					{
+						SC_CHECK(row_data[i] == 0xCD);
+					}
+				}
+			}
+		}
+	}
+}
+
+SC_TEST(astc_thumbnail)
+{
+	// Solid image has the same average color in every block
+	const uint8_t color[Pixel_Size] = { 200, 100, 50, 255 };
+	std::vector<uint8_t> image((size_t)Width * Height * Pixel_Size);
+	for (size_t i = 0; image.size() > i; i++)
+	{
+		image[i] = color[i % Pixel_Size];
+	}
+
+	BufferStream compressed;
+	compress_astc(image, 6, 1, compressed);
+
+	sc::Decompressor::Astc::Props props = decompressor_props(6, 2);
+	sc::Decompressor::Astc decompressor(props);
+	BufferStream thumbnail;
+	decompressor.decompress_thumbnail(Width, Height, compressed, thumbnail);
+
+	size_t columns = (Width + 5) / 6;
+	size_t rows = (Height + 5) / 6;
+	SC_CHECK(thumbnail.length() == columns * rows * Pixel_Size);
+
+	const uint8_t* thumbnail_data = (const uint8_t*)thumbnail.data();
+	for (size_t i = 0; thumbnail.length() > i; i++)
+	{
+		int difference = (int)thumbnail_data[i] - color[i % Pixel_Size];
+		SC_CHECK(difference >= -1 && 1 >= difference);
+	}
+}
+
+SC_TEST(astc_thumbnail_gradient)
+{
+	// Smooth image is encoded with blocks that have different endpoints and weights
+	std::vector<uint8_t> image((size_t)Width * Height * Pixel_Size);
+	for (uint16_t y = 0; Height > y; y++)
+	{
+		for (uint16_t x = 0; Width > x; x++)
+		{
+			uint8_t* pixel = image.data() + ((size_t)y * Width + x) * Pixel_Size;
+			pixel[0] = (uint8_t)(x * 255 / Width);
+			pixel[1] = (uint8_t)(y * 255 / Height);
+			pixel[2] = (uint8_t)((x + y) * 255 / (Width + Height));
+			pixel[3] = 255;
+		}
+	}
+
+	const uint8_t blocks = 6;
+	BufferStream compressed;
+	compress_astc(image, blocks, 1, compressed);
+	BufferStream pixels;
+	decompress_astc(compressed, blocks, pixels);
+	const uint8_t* pixels_data = (const uint8_t*)pixels.data();
+
+	sc::Decompressor::Astc::Props props = decompressor_props(blocks, 2);
+	sc::Decompressor::Astc decompressor(props);
+	BufferStream thumbnail;
+	compressed.seek(0);
+	decompressor.decompress_thumbnail(Width, Height, compressed, thumbnail);
+	const uint8_t* thumbnail_data = (const uint8_t*)thumbnail.data();
+
+	// Color of every full block is close to average of its decoded pixels
+	size_t columns = (Width + blocks - 1) / blocks;
+	for (size_t row = 0; Height / blocks > row; row++)
+	{
+		for (size_t column = 0; Width / blocks > column; column++)
+		{
+			for (size_t channel = 0; Pixel_Size > channel; channel++)
+			{
+				uint32_t sum = 0;
+				for (size_t y = row * blocks; (row + 1) * blocks > y; y++)
+				{
+					for (size_t x = column * blocks; (column + 1) * blocks > x; x++)
+					{
+						sum += pixels_data[(y * Width + x) * Pixel_Size + channel];
+					}
+				}
+
+				int difference = (int)thumbnail_data[(row * columns + column) * Pixel_Size + channel] - (int)(sum / (blocks * blocks));
+				SC_CHECK(difference >= -4 && 4 >= difference);
+			}
+		}
+	}
+}
+
+SC_TEST(astc_file_thumbnail)
+{
+	std::vector<uint8_t> image = sc::test::make_data((size_t)Width * Height * Pixel_Size);
+
+	const uint8_t blocks = 8;
+	BufferStream compressed;
+	compress_astc(image, blocks, 1, compressed);
+
+	sc::Decompressor::Astc::Props props = decompressor_props(blocks, 1);
+	sc::Decompressor::Astc decompressor(props);
+	BufferStream expected;
+	decompressor.decompress_thumbnail(Width, Height, compressed, expected);
+
+	// File has block size and image size in header
+	BufferStream file;
+	file.write(sc::astc::FileIdentifier, sizeof(sc::astc::FileIdentifier));
+	file.write_unsigned_byte(blocks);
+	file.write_unsigned_byte(blocks);
+	file.write_unsigned_byte(1);
+	uint32_t dimensions[] = { Width, Height, 1 };
+	for (uint32_t dimension : dimensions)
+	{
+		file.write(&dimension, 3);
+	}
+	file.write(compressed.data(), compressed.length());
+	file.seek(0);
+
+	// Block size of props is replaced by block size of file
+	sc::Decompressor::Astc::Props file_props = decompressor_props(4, 2);
+	uint16_t width;
+	uint16_t height;
+	BufferStream thumbnail;
+	sc::Decompressor::Astc::read_thumbnail(file, thumbnail, width, height, file_props);
+
+	SC_CHECK(width == (Width + blocks - 1) / blocks);
+	SC_CHECK(height == (Height + blocks - 1) / blocks);
+	SC_CHECK(stream_equals(thumbnail, expected));
+}
+
+SC_TEST(astc_striped_matches_image)
+{
+	std::vector<uint8_t> image = sc::test::make_data((size_t)Width * Height * Pixel_Size);
+	size_t row_length = Width * Pixel_Size;
+
+	BufferStream expected_blocks;
+	compress_astc(image, 4, 2, expected_blocks);
+	BufferStream expected_pixels;
+	decompress_astc(expected_blocks, 4, expected_pixels);
+
+	sc::Compressor::Astc::Props compressor_props;
+	compressor_props.quality = sc::astc::Quality::Fastest;
+	compressor_props.threads_count = 2;
+	sc::Compressor::Astc compressor(compressor_props);
+
+	sc::Decompressor::Astc::Props props = decompressor_props(4, 2);
+	sc::Decompressor::Astc decompressor(props);
+
+	// Single block row, band that does not divide image and band bigger than image
+	const uint32_t bands[] = { 1, 3, 100 };
+	for (uint32_t band_block_rows : bands)
+	{
+		{
+			MemoryStream input(image.data(), image.size());
+			BufferStream blocks;
+			compressor.compress_image_striped(Width, Height, Image::BasePixelType::RGBA, input, blocks, band_block_rows);
+			SC_CHECK(stream_equals(blocks, expected_blocks));
+		}
+
+		{
+			uint32_t next_row = 0;
+			BufferStream blocks;
+			compressor.compress_image_striped(Width, Height, Image::BasePixelType::RGBA,
+				[&](uint32_t first_row, uint32_t rows_count, uint8_t* rows)
+				{
+					SC_CHECK(first_row == next_row);
+					memcpy(rows, image.data() + first_row * row_length, rows_count * row_length);
+					next_row += rows_count;
+				},
+				blocks, band_block_rows
+			);
+			SC_CHECK(next_row == Height);
+			SC_CHECK(stream_equals(blocks, expected_blocks));
+		}
+
+		{
+			expected_blocks.seek(0);
+			BufferStream pixels;
+			decompressor.decompress_image_striped(Width, Height, Image::BasePixelType::RGBA, expected_blocks, pixels, band_block_rows);
+			SC_CHECK(stream_equals(pixels, expected_pixels));
+		}
+
+		{
+			uint32_t next_row = 0;
+			const uint8_t* expected_data = (const uint8_t*)expected_pixels.data();
+
+			expected_blocks.seek(0);
+			decompressor.decompress_image_striped(Width, Height, Image::BasePixelType::RGBA, expected_blocks,
+				[&](uint32_t first_row, uint32_t rows_count, const uint8_t* rows)
+				{
+					SC_CHECK(first_row == next_row);
+					SC_CHECK(memcmp(rows, expected_data + first_row * row_length, rows_count * row_length) == 0);
+					next_row += rows_count;
+				},
+				band_block_rows
+			);
+			SC_CHECK(next_row == Height);
+		}
+	}
+}
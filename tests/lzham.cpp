@@ -0,0 +1,136 @@
+#include "test.h"
+
+#include "SupercellCompression/Lzham.h"
+#include "SupercellCompression/exception/Lzham.h"
+#include "io/buffer_stream.h"
+#include "io/file_stream.h"
+#include "io/memory_stream.h"
+
+#include <string.h>
+#include <filesystem>
+
+using sc::BufferStream;
+using sc::MemoryStream;
+using sc::Stream;
+
+static bool stream_equals(Stream& stream, const std::vector<uint8_t>& data)
+{
+	return stream.length() == data.size() && (data.empty() || memcmp(stream.data(), data.data(), data.size()) == 0);
+}
+
+static void compress_lzham(std::vector<uint8_t>& data, BufferStream& output)
+{
+	MemoryStream input(data.data(), data.size());
+	sc::Compressor::Lzham::Props props;
+	props.dict_size_log2 = 18;
+	props.level = sc::lzham::Level::FASTEST;
+	sc::Compressor::Lzham compressor(props);
+	compressor.compress_stream(input, output);
+	output.seek(0);
+}
+
+static sc::Decompressor::Lzham::Props decompressor_props(size_t unpacked_length)
+{
+	sc::Decompressor::Lzham::Props props;
+	props.dict_size_log2 = 18;
+	props.unpacked_length = unpacked_length;
+	return props;
+}
+
+SC_TEST(lzham_known_length_round_trip)
+{
+	std::vector<uint8_t> data = sc::test::make_data(700000);
+	BufferStream compressed;
+	compress_lzham(data, compressed);
+
+	// Known length is decoded by single unbuffered call into buffer of final size
+	{
+		compressed.seek(0);
+		sc::Decompressor::Lzham::Props props = decompressor_props(data.size());
+		sc::Decompressor::Lzham decompressor(props);
+
+		BufferStream decompressed;
+		decompressor.decompress_stream(compressed, decompressed);
+		SC_CHECK(decompressed.position() == data.size());
+		SC_CHECK(stream_equals(decompressed, data));
+	}
+
+	// Fixed memory is written in place
+	{
+		compressed.seek(0);
+		sc::Decompressor::Lzham::Props props = decompressor_props(data.size());
+		sc::Decompressor::Lzham decompressor(props);
+
+		std::vector<uint8_t> destination(data.size());
+		MemoryStream decompressed(destination.data(), destination.size());
+		decompressor.decompress_stream(compressed, decompressed);
+		SC_CHECK(decompressed.position() == data.size());
+		SC_CHECK(destination == data);
+	}
+
+	// Compressed data that is not in memory is read once and decoded the same way
+	{
+		std::filesystem::path path = std::filesystem::temp_directory_path() / "lzham_known_length.bin";
+		{
+			sc::OutputFileStream file(path);
+			file.write(compressed.data(), compressed.length());
+		}
+
+		{
+			sc::InputFileStream input(path);
+			sc::Decompressor::Lzham::Props props = decompressor_props(data.size());
+			sc::Decompressor::Lzham decompressor(props);
+
+			BufferStream decompressed;
+			decompressor.decompress_stream(input, decompressed);
+			SC_CHECK(stream_equals(decompressed, data));
+		}
+
+		std::filesystem::remove(path);
+	}
+}
+
+SC_TEST(lzham_streaming_fallback)
+{
+	std::vector<uint8_t> data = sc::test::make_data(700000);
+	BufferStream compressed;
+	compress_lzham(data, compressed);
+
+	// Unknown length goes through stream buffers until end of LZHAM stream
+	{
+		sc::Decompressor::Lzham::Props props = decompressor_props(SIZE_MAX);
+		sc::Decompressor::Lzham decompressor(props);
+
+		BufferStream decompressed;
+		decompressor.decompress_stream(compressed, decompressed);
+		SC_CHECK(stream_equals(decompressed, data));
+	}
+
+	// Output limit keeps streaming path, so only beginning is decoded
+	{
+		compressed.seek(0);
+		sc::Decompressor::Lzham::Props props = decompressor_props(data.size());
+		sc::Decompressor::Lzham decompressor(props);
+		decompressor.set_output_limit(100000);
+
+		BufferStream decompressed;
+		decompressor.decompress_stream(compressed, decompressed);
+		SC_CHECK(decompressed.length() == 100000);
+		SC_CHECK(memcmp(decompressed.data(), data.data(), 100000) == 0);
+	}
+}
+
+SC_TEST(lzham_known_length_truncated)
+{
+	std::vector<uint8_t> data = sc::test::make_data(300000);
+	BufferStream compressed;
+	compress_lzham(data, compressed);
+
+	// Unbuffered decoder must produce exactly the known length
+	MemoryStream truncated((uint8_t*)compressed.data(), compressed.length() / 2);
+	sc::Decompressor::Lzham::Props props = decompressor_props(data.size());
+	sc::Decompressor::Lzham decompressor(props);
+
+	BufferStream decompressed;
+	SC_CHECK_THROWS(decompressor.decompress_stream(truncated, decompressed), sc::LzhamCorruptedDecompressException);
+}
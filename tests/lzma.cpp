@@ -0,0 +1,259 @@
+#include "test.h"
+
+#include "SupercellCompression/Lzma.h"
+#include "SupercellCompression/Lzma2.h"
+#include "SupercellCompression/exception/Lzma.h"
+#include "io/buffer_stream.h"
+#include "io/memory_stream.h"
+
+#include <string.h>
+
+using sc::BufferStream;
+using sc::MemoryStream;
+using sc::Stream;
+
+static bool stream_equals(Stream& stream, const std::vector<uint8_t>& data)
+{
+	return stream.length() == data.size() && (data.empty() || memcmp(stream.data(), data.data(), data.size()) == 0);
+}
+
+// Compresses data and reads LZMA header from the start of output, leaving output at compressed data
+static uint64_t compress_lzma(std::vector<uint8_t>& data, sc::Compressor::Lzma::Props& props, BufferStream& output, uint8_t header[sc::lzma::PROPS_SIZE])
+{
+	MemoryStream input(data.data(), data.size());
+	sc::Compressor::Lzma compressor(props);
+	compressor.compress_stream(input, output);
+	output.seek(0);
+
+	output.read(header, sc::lzma::PROPS_SIZE);
+	return props.use_long_unpacked_length ? output.read_unsigned_long() : output.read_unsigned_int();
+}
+
+SC_TEST(lzma_direct_round_trip)
+{
+	std::vector<uint8_t> data = sc::test::make_data(700000);
+
+	const bool long_lengths[] = { true, false };
+	for (bool use_long_unpacked_length : long_lengths)
+	{
+		sc::Compressor::Lzma::Props props;
+		props.level = 1;
+		props.use_long_unpacked_length = use_long_unpacked_length;
+
+		uint8_t header[sc::lzma::PROPS_SIZE];
+		BufferStream compressed;
+		uint64_t unpacked_length = compress_lzma(data, props, compressed, header);
+		SC_CHECK(unpacked_length == data.size());
+		size_t data_position = compressed.position();
+
+		// Buffer is resized to known length and used as decoder dictionary
+		{
+			BufferStream decompressed;
+			sc::Decompressor::Lzma decompressor(header, unpacked_length);
+			decompressor.decompress_stream(compressed, decompressed);
+			SC_CHECK(stream_equals(decompressed, data));
+		}
+
+		// Fixed memory is written in place
+		{
+			compressed.seek(data_position);
+			std::vector<uint8_t> destination(data.size());
+			MemoryStream decompressed(destination.data(), destination.size());
+			sc::Decompressor::Lzma decompressor(header, unpacked_length);
+			decompressor.decompress_stream(compressed, decompressed);
+			SC_CHECK(destination == data);
+		}
+	}
+}
+
+SC_TEST(lzma_unknown_length)
+{
+	std::vector<uint8_t> data = sc::test::make_data(300000);
+
+	sc::Compressor::Lzma::Props props;
+	props.level = 1;
+	props.write_end_mark = true;
+
+	uint8_t header[sc::lzma::PROPS_SIZE];
+	BufferStream compressed;
+	compress_lzma(data, props, compressed, header);
+
+	// Without length data is decompressed through ring dictionary until end mark
+	BufferStream decompressed;
+	sc::Decompressor::Lzma decompressor(header, SIZE_MAX);
+	decompressor.decompress_stream(compressed, decompressed);
+	SC_CHECK(stream_equals(decompressed, data));
+}
+
+SC_TEST(lzma_match_finder_thread)
+{
+	std::vector<uint8_t> data = sc::test::make_data(1000000);
+
+	// Binary tree match finder runs in its own thread with 2 threads, single threaded build falls back to 1
+	BufferStream outputs[2];
+	for (int threads = 1; 2 >= threads; threads++)
+	{
+		sc::Compressor::Lzma::Props props;
+		props.level = 5;
+		props.threads = threads;
+
+		uint8_t header[sc::lzma::PROPS_SIZE];
+		BufferStream& compressed = outputs[threads - 1];
+		uint64_t unpacked_length = compress_lzma(data, props, compressed, header);
+		SC_CHECK(unpacked_length == data.size());
+
+		BufferStream decompressed;
+		sc::Decompressor::Lzma decompressor(header, unpacked_length);
+		decompressor.decompress_stream(compressed, decompressed);
+		SC_CHECK(stream_equals(decompressed, data));
+	}
+
+	// Thread only moves match search, so ratio stays about the same
+	size_t single_length = outputs[0].length();
+	size_t threaded_length = outputs[1].length();
+	SC_CHECK(single_length / 100 > (single_length > threaded_length ? single_length - threaded_length : threaded_length - single_length));
+}
+
+SC_TEST(lzma_decoder_props)
+{
+	// Literals repeat with period of 4 bytes, so every literal and position context is used
+	std::vector<uint8_t> data = sc::test::make_data(300000);
+	for (size_t i = 0; data.size() > i; i += 4)
+	{
+		data[i] = (uint8_t)(i >> 10);
+	}
+
+	// Decoder that library is built with (generic C or optimized assembly, see has_optimized_decoder)
+	// gives the same data for any literal context, literal position and position bits
+	const int props_values[][3] = { { 3, 0, 2 }, { 0, 2, 0 }, { 4, 0, 2 }, { 8, 0, 4 }, { 0, 4, 4 } };
+	for (const int* values : props_values)
+	{
+		sc::Compressor::Lzma::Props props;
+		props.level = 1;
+		props.lc = values[0];
+		props.lp = values[1];
+		props.pb = values[2];
+
+		uint8_t header[sc::lzma::PROPS_SIZE];
+		BufferStream compressed;
+		uint64_t unpacked_length = compress_lzma(data, props, compressed, header);
+
+		BufferStream decompressed;
+		sc::Decompressor::Lzma decompressor(header, unpacked_length);
+		decompressor.decompress_stream(compressed, decompressed);
+		SC_CHECK(stream_equals(decompressed, data));
+	}
+}
+
+// Reads LZMA header with 64-bit length and decompresses rest of stream
+static void decompress_lzma(BufferStream& compressed, BufferStream& output)
+{
+	uint8_t header[sc::lzma::PROPS_SIZE];
+	compressed.read(header, sc::lzma::PROPS_SIZE);
+	uint64_t unpacked_length = compressed.read_unsigned_long();
+
+	sc::Decompressor::Lzma decompressor(header, unpacked_length);
+	decompressor.decompress_stream(compressed, output);
+}
+
+SC_TEST(lzma_encoder_reuse)
+{
+	std::vector<uint8_t> first = sc::test::make_data(200000, 1);
+	std::vector<uint8_t> second = sc::test::make_data(50000, 2);
+
+	sc::Compressor::Lzma::Props props;
+	props.level = 1;
+	sc::Compressor::Lzma compressor(props);
+
+	// Same instance compresses several streams and keeps working after props change
+	std::vector<uint8_t>* inputs[] = { &first, &second, &first };
+	for (size_t i = 0; 3 > i; i++)
+	{
+		if (i == 2)
+		{
+			props.dict_size = 1 << 16;
+			compressor.reset(props);
+		}
+
+		MemoryStream input(inputs[i]->data(), inputs[i]->size());
+		BufferStream compressed;
+		compressor.compress_stream(input, compressed);
+		compressed.seek(0);
+
+		BufferStream decompressed;
+		decompress_lzma(compressed, decompressed);
+		SC_CHECK(stream_equals(decompressed, *inputs[i]));
+	}
+}
+
+SC_TEST(lzma2_round_trip)
+{
+	std::vector<uint8_t> data = sc::test::make_data(1000000);
+
+	const uint32_t threads[] = { 1, 4 };
+	for (uint32_t threads_count : threads)
+	{
+		sc::Compressor::Lzma2::Props props;
+		props.level = 1;
+		props.block_size = 128 * 1024;
+		props.threads_count = threads_count;
+
+		MemoryStream input(data.data(), data.size());
+		BufferStream compressed;
+		sc::Compressor::Lzma2 compressor(props);
+		compressor.compress_stream(input, compressed);
+		compressed.seek(0);
+
+		// Header: dictionary size property byte and 64-bit unpacked length
+		SC_CHECK(compressed.length() > sc::lzma2::HEADER_SIZE);
+		sc::Decompressor::Lzma2::Props decompressor_props;
+		decompressor_props.dict_size_prop = compressed.read_unsigned_byte();
+		decompressor_props.unpacked_length = compressed.read_unsigned_long();
+		SC_CHECK(decompressor_props.dict_size_prop <= 40);
+		SC_CHECK(decompressor_props.unpacked_length == data.size());
+
+		// Blocks are independent, so data compressed by any number of threads is decompressed by any number of threads
+		for (uint32_t decompressor_threads : threads)
+		{
+			compressed.seek(sc::lzma2::HEADER_SIZE);
+			decompressor_props.threads_count = decompressor_threads;
+
+			BufferStream decompressed;
+			sc::Decompressor::Lzma2 decompressor(decompressor_props);
+			decompressor.decompress_stream(compressed, decompressed);
+			SC_CHECK(stream_equals(decompressed, data));
+		}
+	}
+}
+
+SC_TEST(lzma2_truncated_stream)
+{
+	std::vector<uint8_t> data = sc::test::make_data(1000000);
+
+	sc::Compressor::Lzma2::Props props;
+	props.level = 1;
+	props.block_size = 128 * 1024;
+	props.threads_count = 1;
+
+	MemoryStream input(data.data(), data.size());
+	BufferStream compressed;
+	sc::Compressor::Lzma2 compressor(props);
+	compressor.compress_stream(input, compressed);
+
+	// Half of compressed data is lost
+	compressed.seek(0);
+	sc::Decompressor::Lzma2::Props decompressor_props;
+	decompressor_props.dict_size_prop = compressed.read_unsigned_byte();
+	decompressor_props.unpacked_length = compressed.read_unsigned_long();
+	decompressor_props.threads_count = 1;
+
+	MemoryStream truncated((uint8_t*)compressed.data() + sc::lzma2::HEADER_SIZE, (compressed.length() - sc::lzma2::HEADER_SIZE) / 2);
+	BufferStream decompressed;
+	sc::Decompressor::Lzma2 decompressor(decompressor_props);
+	SC_CHECK_THROWS(decompressor.decompress_stream(truncated, decompressed), sc::LzmaDecompressException);
+
+	// Output has only decoded data, not length from header
+	SC_CHECK(data.size() > decompressed.length());
+	SC_CHECK(decompressed.position() == decompressed.length());
+	SC_CHECK(memcmp(decompressed.data(), data.data(), decompressed.length()) == 0);
+}
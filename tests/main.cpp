@@ -0,0 +1,73 @@
+#include "test.h"
+
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace sc
+{
+	namespace test
+	{
+		std::vector<TestCase>& test_cases()
+		{
+			static std::vector<TestCase> cases;
+			return cases;
+		}
+
+		std::vector<uint8_t> make_data(size_t length, uint32_t seed)
+		{
+			static const char text[] = "name,width,height,frames;sc/ui.sc;";
+
+			std::mt19937 random(seed);
+			std::vector<uint8_t> data(length);
+			for (size_t i = 0; length > i; i++)
+			{
+				data[i] = random() % 8 == 0 ? static_cast<uint8_t>(random()) : static_cast<uint8_t>(text[i % (sizeof(text) - 1)]);
+			}
+
+			return data;
+		}
+	}
+}
+
+// Runs all test cases or only cases which name contains first argument
+int main(int argc, char* argv[])
+{
+	using namespace sc::test;
+
+	std::string filter = argc > 1 ? argv[1] : "";
+
+	uint32_t failed_count = 0;
+	uint32_t run_count = 0;
+	for (const TestCase& test_case : test_cases())
+	{
+		if (!filter.empty() && std::string(test_case.name).find(filter) == std::string::npos) continue;
+
+		run_count++;
+		try
+		{
+			test_case.function();
+			std::cout << "[PASS] " << test_case.name << std::endl;
+		}
+		catch (const CheckFailure& failure)
+		{
+			failed_count++;
+			std::cout << "[FAIL] " << test_case.name << ": " << failure.condition << " (" << failure.file << ":" << failure.line << ")" << std::endl;
+		}
+		catch (const std::exception& exception)
+		{
+			failed_count++;
+			std::cout << "[FAIL] " << test_case.name << ": exception " << exception.what() << std::endl;
+		}
+		catch (...)
+		{
+			failed_count++;
+			std::cout << "[FAIL] " << test_case.name << ": unknown exception" << std::endl;
+		}
+	}
+
+	std::cout << run_count - failed_count << " of " << run_count << " tests passed" << std::endl;
+
+	return failed_count == 0 ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+#include "test.h"
+
+#include "SupercellCompression/MappedFileStream.h"
+#include "SupercellCompression/ScCompression.h"
+#include "SupercellCompression/exception/MappedFileStream.h"
+#include "io/buffer_stream.h"
+#include "io/file_stream.h"
+
+#include <string.h>
+#include <filesystem>
+
+using sc::MemoryStream;
+
+SC_TEST(mapped_output_truncated_to_written)
+{
+	std::vector<uint8_t> data = sc::test::make_data(300000);
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "mapped_output_truncated.bin";
+
+	// Header promised more data than stream has, so file is cut to data that was written
+	{
+		sc::OutputMappedFileStream output(path, 1000000);
+		SC_CHECK(output.length() == 1000000);
+		output.write(data.data(), data.size());
+	}
+	SC_CHECK(std::filesystem::file_size(path) == data.size());
+
+	{
+		sc::InputMappedFileStream input(path);
+		SC_CHECK(input.length() == data.size());
+		SC_CHECK(memcmp(input.data(), data.data(), data.size()) == 0);
+	}
+
+	std::filesystem::remove(path);
+}
+
+SC_TEST(mapped_input_decompressed)
+{
+	std::vector<uint8_t> data = sc::test::make_data(300000);
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "mapped_input_decompressed.sc";
+
+	// SC file is written with regular stream and decoded straight from mapped pages
+	{
+		MemoryStream input(data.data(), data.size());
+		sc::BufferStream compressed;
+		sc::ScCompression::Compressor::CompressorContext context;
+		context.signature = sc::ScCompression::Signature::Zstandard;
+		sc::ScCompression::Compressor::compress(input, compressed, context);
+
+		sc::OutputFileStream file(path);
+		file.write(compressed.data(), compressed.length());
+	}
+
+	{
+		sc::InputMappedFileStream input(path);
+		SC_CHECK(input.length() == std::filesystem::file_size(path));
+		SC_CHECK(input.position() == 0);
+
+		sc::BufferStream decompressed;
+		sc::ScCompression::Decompressor::decompress(input, decompressed);
+		SC_CHECK(decompressed.length() == data.size());
+		SC_CHECK(memcmp(decompressed.data(), data.data(), data.size()) == 0);
+	}
+
+	std::filesystem::remove(path);
+}
+
+SC_TEST(mapped_input_empty_and_missing)
+{
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "mapped_input_empty.bin";
+	{
+		sc::OutputFileStream file(path);
+	}
+
+	// Empty file has nothing to map, but is still a valid stream
+	{
+		sc::InputMappedFileStream input(path);
+		SC_CHECK(input.length() == 0);
+	}
+
+	std::filesystem::remove(path);
+	SC_CHECK_THROWS(sc::InputMappedFileStream input(path), sc::MappedFileOpenException);
+}
@@ -0,0 +1,453 @@
+#include "test.h"
+
+#include "SupercellCompression/ScCompression.h"
+#include "SupercellCompression/Sc/Tuning.h"
+#include "SupercellCompression/exception/ScCompression.h"
+#include "generic/md5.h"
+#include "io/buffer_stream.h"
+#include "io/file_stream.h"
+#include "io/memory_stream.h"
+
+#include <string.h>
+#include <algorithm>
+#include <filesystem>
+
+using namespace sc::ScCompression;
+using sc::BufferStream;
+using sc::MemoryStream;
+using sc::Stream;
+
+static const Signature Signatures[] = { Signature::Lzma, Signature::Lzham, Signature::Zstandard };
+
+static void compress_sc(std::vector<uint8_t>& data, BufferStream& output, Compressor::CompressorContext& context)
+{
+	MemoryStream input(data.data(), data.size());
+	Compressor::compress(input, output, context);
+	output.seek(0);
+}
+
+static bool stream_equals(Stream& stream, const std::vector<uint8_t>& data)
+{
+	return stream.length() == data.size() && (data.empty() || memcmp(stream.data(), data.data(), data.size()) == 0);
+}
+
+SC_TEST(sc_hash_is_backpatched)
+{
+	std::vector<uint8_t> data = sc::test::make_data(300000);
+
+	uint8_t data_hash[16];
+	sc::md5 md_ctx;
+	md_ctx.update(data.data(), data.size());
+	md_ctx.final(data_hash);
+
+	for (Signature signature : Signatures)
+	{
+		Compressor::CompressorContext context;
+		context.signature = signature;
+		BufferStream compressed;
+		compress_sc(data, compressed, context);
+
+		// Hash in header is calculated while data is compressed and written over placeholder after it
+		Info info = inspect(compressed);
+		SC_CHECK(info.signature == signature);
+		SC_CHECK(info.hash.size() == sizeof(data_hash));
+		SC_CHECK(memcmp(info.hash.data(), data_hash, sizeof(data_hash)) == 0);
+
+		BufferStream decompressed;
+		Decompressor::decompress(compressed, decompressed);
+		SC_CHECK(stream_equals(decompressed, data));
+	}
+}
+
+SC_TEST(sc_hash_verification)
+{
+	std::vector<uint8_t> data = sc::test::make_data(100000);
+
+	for (Signature signature : Signatures)
+	{
+		Compressor::CompressorContext context;
+		context.signature = signature;
+		BufferStream compressed;
+		compress_sc(data, compressed, context);
+
+		Decompressor::DecompressorContext decompressor_context;
+		decompressor_context.verify_hash = true;
+		{
+			BufferStream decompressed;
+			Decompressor::decompress(compressed, decompressed, decompressor_context);
+			SC_CHECK(stream_equals(decompressed, data));
+		}
+
+		// Damaged hash is noticed only when verification is enabled
+		compressed.seek(0);
+		Info info = inspect(compressed);
+		((uint8_t*)compressed.data())[info.data_offset - 1] ^= 0xFF;
+
+		compressed.seek(0);
+		{
+			BufferStream decompressed;
+			SC_CHECK_THROWS(Decompressor::decompress(compressed, decompressed, decompressor_context), sc::ScCorruptedHashException);
+		}
+
+		compressed.seek(0);
+		{
+			BufferStream decompressed;
+			Decompressor::decompress(compressed, decompressed);
+			SC_CHECK(stream_equals(decompressed, data));
+		}
+	}
+}
+
+SC_TEST(sc_inspect)
+{
+	std::vector<uint8_t> data = sc::test::make_data(200000);
+
+	for (Signature signature : Signatures)
+	{
+		Compressor::CompressorContext context;
+		context.signature = signature;
+		context.frame_size = 64 * 1024;
+		BufferStream compressed;
+		compress_sc(data, compressed, context);
+
+		Info info = inspect(compressed);
+		SC_CHECK(compressed.position() == 0);
+		SC_CHECK(info.signature == signature);
+		SC_CHECK(info.version == (signature == Signature::Zstandard ? 3u : 1u));
+		SC_CHECK(!info.has_metadata);
+		SC_CHECK(info.data_offset + info.data_length == compressed.length());
+
+		// Zstandard length is summed from all frames
+		SC_CHECK(info.unpacked_length == data.size());
+	}
+
+	// LZMA header with all bits set in length means that length is unknown
+	{
+		Compressor::CompressorContext context;
+		context.signature = Signature::Lzma;
+		BufferStream compressed;
+		compress_sc(data, compressed, context);
+
+		Info info = inspect(compressed);
+		memset((uint8_t*)compressed.data() + info.data_offset + sc::lzma::PROPS_SIZE, 0xFF, sizeof(uint32_t));
+
+		info = inspect(compressed);
+		SC_CHECK(info.unpacked_length == Info::UnknownLength);
+	}
+}
+
+// Builds metadata chunk with one byte wide fields, like metadata of small SC files, followed by its big endian length
+static std::vector<uint8_t> make_metadata(const std::vector<MetadataAsset>& assets)
+{
+	std::vector<uint8_t> metadata;
+	uint8_t count = static_cast<uint8_t>(assets.size());
+
+	std::vector<size_t> name_positions;
+	for (const MetadataAsset& asset : assets)
+	{
+		name_positions.push_back(metadata.size());
+		metadata.insert(metadata.end(), asset.name.begin(), asset.name.end());
+		metadata.push_back(0);
+	}
+
+	// Hash blob is prefixed with its length
+	std::vector<size_t> hash_positions;
+	for (const MetadataAsset& asset : assets)
+	{
+		metadata.push_back(static_cast<uint8_t>(asset.hash.size()));
+		hash_positions.push_back(metadata.size());
+		metadata.insert(metadata.end(), asset.hash.begin(), asset.hash.end());
+	}
+
+	// Name offsets are counted back from offset field
+	metadata.push_back(count);
+	size_t strings_position = metadata.size();
+	for (uint8_t i = 0; count > i; i++)
+	{
+		metadata.push_back(static_cast<uint8_t>(strings_position + i - name_positions[i]));
+	}
+
+	// Asset info: strings offset, unused byte, count, hash offsets and hash flags
+	size_t asset_info_position = metadata.size() + 3;
+	metadata.push_back(static_cast<uint8_t>(asset_info_position - 3 - strings_position));
+	metadata.push_back(1);
+	metadata.push_back(count);
+	for (uint8_t i = 0; count > i; i++)
+	{
+		metadata.push_back(static_cast<uint8_t>(asset_info_position + i - hash_positions[i]));
+	}
+	for (uint8_t i = 0; count > i; i++)
+	{
+		metadata.push_back(0x19 << 2);
+	}
+
+	size_t root_position = metadata.size();
+	metadata.push_back(static_cast<uint8_t>(root_position - asset_info_position));
+
+	// Flags and width of root offset
+	metadata.push_back(0x24);
+	metadata.push_back(1);
+
+	uint32_t length = static_cast<uint32_t>(metadata.size());
+	for (int shift = 24; shift >= 0; shift -= 8)
+	{
+		metadata.push_back(static_cast<uint8_t>(length >> shift));
+	}
+
+	return metadata;
+}
+
+static bool asset_equals(const MetadataView::Asset& view, const MetadataAsset& asset)
+{
+	return view.name == asset.name && view.hash_length == asset.hash.size() &&
+		memcmp(view.hash, asset.hash.data(), asset.hash.size()) == 0;
+}
+
+SC_TEST(sc_metadata_view)
+{
+	std::vector<MetadataAsset> assets = {
+		{ "ui.sc", { 1, 2, 3, 4 } },
+		{ "background.sc", { 5, 6, 7, 8, 9, 10 } },
+		{ "effects.sc", { 11 } },
+	};
+
+	std::vector<uint8_t> metadata = make_metadata(assets);
+
+	MetadataView view(metadata.data() + metadata.size());
+	SC_CHECK(view.size() == assets.size());
+
+	uint32_t index = 0;
+	for (MetadataView::Asset asset : view)
+	{
+		SC_CHECK(asset_equals(asset, assets[index++]));
+	}
+
+	MetadataView::Asset found;
+	SC_CHECK(view.find("background.sc", found));
+	SC_CHECK(asset_equals(found, assets[1]));
+	SC_CHECK(!view.find("missing.sc", found));
+
+	// View without index still reads assets, but can not find them
+	MetadataView unindexed(metadata.data() + metadata.size(), false);
+	SC_CHECK(asset_equals(unindexed.at(2), assets[2]));
+	SC_CHECK(!unindexed.find("ui.sc", found));
+
+	// Version 4 file: version 4 before real version, START and metadata after compressed data
+	std::vector<uint8_t> data = sc::test::make_data(50000);
+
+	Compressor::CompressorContext context;
+	BufferStream compressed;
+	compress_sc(data, compressed, context);
+
+	BufferStream file;
+	file.write_unsigned_short(SC_MAGIC);
+	file.write_unsigned_int(4, sc::Endian::Big);
+	file.write((uint8_t*)compressed.data() + sizeof(uint16_t), compressed.length() - sizeof(uint16_t));
+	file.write("START", 5);
+	file.write(metadata.data(), metadata.size());
+	file.seek(0);
+
+	Info info = inspect(file);
+	SC_CHECK(info.has_metadata);
+	SC_CHECK(info.metadata_length + sizeof(uint32_t) == metadata.size());
+
+	MetadataAssetArray decompressed_assets;
+	BufferStream decompressed;
+	Decompressor::decompress(file, decompressed, &decompressed_assets);
+	SC_CHECK(stream_equals(decompressed, data));
+	SC_CHECK(decompressed_assets.size() == assets.size());
+	for (size_t i = 0; assets.size() > i; i++)
+	{
+		SC_CHECK(decompressed_assets[i].name == assets[i].name);
+		SC_CHECK(decompressed_assets[i].hash == assets[i].hash);
+	}
+}
+
+SC_TEST(sc_range)
+{
+	std::vector<uint8_t> data = sc::test::make_data(400000);
+
+	for (Signature signature : Signatures)
+	{
+		Compressor::CompressorContext context;
+		context.signature = signature;
+		context.frame_size = 64 * 1024;
+		context.write_seek_table = true;
+		BufferStream compressed;
+		compress_sc(data, compressed, context);
+
+		const size_t ranges[][2] = {
+			{ 0, 10 },
+			{ 70000, 100000 },
+			{ 390000, SIZE_MAX },
+			{ data.size(), 1 },
+		};
+
+		for (const size_t* range : ranges)
+		{
+			compressed.seek(0);
+			BufferStream output;
+			Decompressor::decompress_range(compressed, output, range[0], range[1]);
+
+			size_t offset = std::min(range[0], data.size());
+			size_t length = std::min(range[1], data.size() - offset);
+			SC_CHECK(output.length() == length);
+			SC_CHECK(length == 0 || memcmp(output.data(), data.data() + offset, length) == 0);
+		}
+	}
+}
+
+SC_TEST(sc_range_context)
+{
+	std::vector<uint8_t> data = sc::test::make_data(300000);
+	std::vector<uint8_t> dictionary_content = sc::test::make_data(16 * 1024, 2);
+	sc::zstd::Dictionary dictionary(dictionary_content.data(), dictionary_content.size());
+
+	Compressor::CompressorContext context;
+	context.frame_size = 64 * 1024;
+	context.write_seek_table = true;
+	context.dictionary = &dictionary;
+	BufferStream compressed;
+	compress_sc(data, compressed, context);
+
+	// Frames are decompressed with dictionary from context
+	Decompressor::DecompressorContext decompressor_context;
+	decompressor_context.dictionary = &dictionary;
+	{
+		BufferStream output;
+		Decompressor::decompress_range(compressed, output, decompressor_context, 100000, 50000);
+		SC_CHECK(output.length() == 50000);
+		SC_CHECK(memcmp(output.data(), data.data() + 100000, 50000) == 0);
+	}
+
+	// Version 4 file read from disk: seek table is before START and metadata.
+	// First frame is damaged, so range is decompressed only if frames are found by seek table
+	compressed.seek(0);
+	Info info = inspect(compressed);
+	memset((uint8_t*)compressed.data() + info.data_offset, 0, sizeof(uint32_t));
+
+	std::vector<uint8_t> metadata = make_metadata({ { "ui.sc", { 1, 2, 3 } } });
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "sc_range_context.sc";
+	{
+		sc::OutputFileStream file(path);
+		file.write_unsigned_short(SC_MAGIC);
+		file.write_unsigned_int(4, sc::Endian::Big);
+		file.write((uint8_t*)compressed.data() + sizeof(uint16_t), compressed.length() - sizeof(uint16_t));
+		file.write("START", 5);
+		file.write(metadata.data(), metadata.size());
+	}
+
+	{
+		sc::InputFileStream file(path);
+		BufferStream output;
+		Decompressor::decompress_range(file, output, decompressor_context, 250000, 10000);
+		SC_CHECK(output.length() == 10000);
+		SC_CHECK(memcmp(output.data(), data.data() + 250000, 10000) == 0);
+	}
+
+	std::filesystem::remove(path);
+}
+
+SC_TEST(sc_auto_signature)
+{
+	std::vector<uint8_t> data = sc::test::make_data(600000);
+	std::vector<uint8_t> dictionary_content = sc::test::make_data(16 * 1024, 2);
+	sc::zstd::Dictionary dictionary(dictionary_content.data(), dictionary_content.size());
+
+	// Samples are compressed with the same dictionary as file, so they must be decompressed with it too
+	const sc::zstd::Dictionary* dictionaries[] = { nullptr, &dictionary };
+	for (const sc::zstd::Dictionary* context_dictionary : dictionaries)
+	{
+		Compressor::CompressorContext context;
+		context.signature = Signature::Auto;
+		context.auto_selection.samples_count = 2;
+		context.auto_selection.sample_size = 64 * 1024;
+		context.dictionary = context_dictionary;
+		BufferStream compressed;
+		compress_sc(data, compressed, context);
+
+		Info info = inspect(compressed);
+		SC_CHECK(info.signature != Signature::Auto);
+
+		Decompressor::DecompressorContext decompressor_context;
+		decompressor_context.dictionary = context_dictionary;
+		BufferStream decompressed;
+		Decompressor::decompress(compressed, decompressed, decompressor_context);
+		SC_CHECK(stream_equals(decompressed, data));
+	}
+}
+
+SC_TEST(sc_tuning_by_length)
+{
+	// Small input gets small dictionary and no threads even when they are available
+	{
+		sc::Compressor::Lzma::Props props;
+		Compressor::tune_props(props, 1000, 4);
+		SC_CHECK(props.dict_size == 1 << 16);
+		SC_CHECK(props.level == 6);
+		SC_CHECK(props.threads == 1);
+
+		// Dictionary grows with input up to limit of row, match finder thread is used only with several threads
+		Compressor::tune_props(props, 3 << 20, 4);
+		SC_CHECK(props.dict_size == 4 << 20);
+		SC_CHECK(props.threads == 2);
+		Compressor::tune_props(props, 3 << 20, 1);
+		SC_CHECK(props.threads == 1);
+
+		Compressor::tune_props(props, (size_t)1 << 30, 4);
+		SC_CHECK(props.dict_size == 1 << 25);
+		SC_CHECK(props.level == 7);
+	}
+
+	{
+		sc::Compressor::Lzham::Props props;
+		Compressor::tune_props(props, 1000, 4);
+		SC_CHECK(props.dict_size_log2 == sc::lzham::MIN_DICT_SIZE_LOG2);
+		SC_CHECK(props.max_helper_threads == 0);
+
+		Compressor::tune_props(props, 2 << 20, 4);
+		SC_CHECK(props.dict_size_log2 == 21);
+		SC_CHECK(props.max_helper_threads == 3);
+	}
+
+	{
+		sc::Compressor::Zstd::Props props;
+		Compressor::tune_props(props, 1000, 4);
+		SC_CHECK(props.compression_level == 16);
+		SC_CHECK(props.workers_count == 0);
+
+		// One worker per job of 1 MB, but no more than threads
+		Compressor::tune_props(props, 8 << 20, 4);
+		SC_CHECK(props.workers_count == 4);
+		SC_CHECK(props.job_size == 1 << 20);
+		Compressor::tune_props(props, 8 << 20, 1);
+		SC_CHECK(props.workers_count == 0);
+		SC_CHECK(props.job_size == 0);
+
+		Compressor::tune_props(props, 32 << 20, 4);
+		SC_CHECK(props.window_log == 24);
+	}
+}
+
+SC_TEST(sc_lzham_dictionary_cap)
+{
+	std::vector<uint8_t> data = sc::test::make_data(2 << 20);
+
+	// Tuning would select dictionary of 2^21, header keeps size of files before tuning unless context allows more
+	for (bool large_dictionary : { false, true })
+	{
+		Compressor::CompressorContext context;
+		context.signature = Signature::Lzham;
+		context.lzham_large_dictionary = large_dictionary;
+		BufferStream compressed;
+		compress_sc(data, compressed, context);
+
+		Info info = inspect(compressed);
+		uint8_t dict_size_log2 = ((const uint8_t*)compressed.data())[info.data_offset + sizeof(SCLZ_MAGIC)];
+		SC_CHECK(dict_size_log2 == (large_dictionary ? 21 : SCLZ_DEFAULT_DICT_SIZE_LOG2));
+
+		BufferStream decompressed;
+		Decompressor::decompress(compressed, decompressed);
+		SC_CHECK(stream_equals(decompressed, data));
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <functional>
+#include <vector>
+
+namespace sc
+{
+	namespace test
+	{
+		// Thrown by SC_CHECK, so test stops on first failed check
+		struct CheckFailure
+		{
+			const char* condition;
+			const char* file;
+			int line;
+		};
+
+		struct TestCase
+		{
+			const char* name;
+			std::function<void()> function;
+		};
+
+		std::vector<TestCase>& test_cases();
+
+		// Adds test case to list that is run by main
+		struct Registration
+		{
+			Registration(const char* name, std::function<void()> function)
+			{
+				test_cases().push_back({ name, function });
+			}
+		};
+
+		/// <summary>
+		/// Creates deterministic data that compresses like real files: repeated text with random bytes between it
+		/// </summary>
+		/// <param name="length">Length of data</param>
+		/// <param name="seed">Data with the same seed and length is always the same</param>
+		std::vector<uint8_t> make_data(size_t length, uint32_t seed = 1);
+	}
+}
+
+#define SC_TEST(name) \
+	static void name(); \
+	static sc::test::Registration name##_registration(#name, name); \
+	static void name()
+
+#define SC_CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) throw sc::test::CheckFailure{ #condition, __FILE__, __LINE__ }; \
+	} while (0)
+
+#define SC_CHECK_THROWS(expression, exception) \
+	do \
+	{ \
+		bool thrown = false; \
+		try { expression; } \
+		catch (const exception&) { thrown = true; } \
+		if (!thrown) throw sc::test::CheckFailure{ #expression " throws " #exception, __FILE__, __LINE__ }; \
+	} while (0)
@@ -0,0 +1,528 @@
+#include "test.h"
+
+#include "SupercellCompression/Zstd.h"
+#include "SupercellCompression/exception/Zstd.h"
+#include "io/buffer_stream.h"
+#include "io/file_stream.h"
+#include "io/memory_stream.h"
+
+#include <string.h>
+#include <algorithm>
+#include <filesystem>
+
+using sc::BufferStream;
+using sc::MemoryStream;
+using sc::Stream;
+
+static void compress_zstd(std::vector<uint8_t>& data, BufferStream& output, sc::Compressor::Zstd::Props& props)
+{
+	MemoryStream input(data.data(), data.size());
+	sc::Compressor::Zstd compressor(props);
+	compressor.compress_stream(input, output);
+	output.seek(0);
+}
+
+static bool memory_equals(const void* memory, size_t length, const uint8_t* data, size_t data_length)
+{
+	return length == data_length && (length == 0 || memcmp(memory, data, length) == 0);
+}
+
+static bool stream_equals(Stream& stream, const std::vector<uint8_t>& data)
+{
+	return memory_equals(stream.data(), stream.length(), data.data(), data.size());
+}
+
+SC_TEST(zstd_frames_round_trip)
+{
+	std::vector<uint8_t> data = sc::test::make_data(1000000);
+
+	for (size_t frame_size : { (size_t)0, (size_t)64 * 1024, (size_t)300000 })
+	{
+		sc::Compressor::Zstd::Props props;
+		props.frame_size = frame_size;
+		props.workers_count = 0;
+		BufferStream compressed;
+		compress_zstd(data, compressed, props);
+
+		// Frames are decompressed by one thread and by several threads into growing buffer and into memory of final size
+		for (uint32_t threads_count : { 1u, 4u })
+		{
+			sc::Decompressor::Zstd::Props decompressor_props;
+			decompressor_props.threads_count = threads_count;
+
+			{
+				compressed.seek(0);
+				BufferStream decompressed;
+				sc::Decompressor::Zstd decompressor(decompressor_props);
+				decompressor.decompress_stream(compressed, decompressed);
+				SC_CHECK(stream_equals(decompressed, data));
+			}
+
+			{
+				compressed.seek(0);
+				std::vector<uint8_t> memory(data.size());
+				MemoryStream decompressed(memory.data(), memory.size());
+				size_t callback_length = 0;
+
+				sc::Decompressor::Zstd decompressor(decompressor_props);
+				decompressor.set_output_callback([&callback_length](const uint8_t*, size_t length) { callback_length += length; });
+				decompressor.decompress_stream(compressed, decompressed);
+				SC_CHECK(decompressed.position() == data.size());
+				SC_CHECK(callback_length == data.size());
+				SC_CHECK(memory == data);
+			}
+		}
+	}
+}
+
+// Range is clamped to data, like decompress_range does
+static bool range_equals(Stream& stream, const std::vector<uint8_t>& data, size_t offset, size_t length)
+{
+	if (offset >= data.size()) return stream.length() == 0;
+
+	size_t range_length = std::min(length, data.size() - offset);
+	return memory_equals(stream.data(), stream.length(), data.data() + offset, range_length);
+}
+
+SC_TEST(zstd_seek_table_range)
+{
+	std::vector<uint8_t> data = sc::test::make_data(500000);
+	const size_t frame_size = 64 * 1024;
+
+	for (bool write_seek_table : { true, false })
+	{
+		sc::Compressor::Zstd::Props props;
+		props.frame_size = frame_size;
+		props.write_seek_table = write_seek_table;
+		props.workers_count = 0;
+		BufferStream compressed;
+		compress_zstd(data, compressed, props);
+
+		// Seek table is a skippable frame at the end of data with seekable format footer
+		if (write_seek_table)
+		{
+			size_t frames_count = (data.size() + frame_size - 1) / frame_size;
+			size_t table_length = sc::zstd::SKIPPABLE_FRAME_HEADER_SIZE + frames_count * sc::zstd::SEEK_TABLE_ENTRY_SIZE + sc::zstd::SEEK_TABLE_FOOTER_SIZE;
+			SC_CHECK(compressed.length() > table_length);
+
+			compressed.seek(compressed.length() - table_length);
+			SC_CHECK(compressed.read_unsigned_int() == sc::zstd::SKIPPABLE_FRAME_MAGIC);
+
+			compressed.seek(compressed.length() - sc::zstd::SEEK_TABLE_FOOTER_SIZE);
+			SC_CHECK(compressed.read_unsigned_int() == frames_count);
+			compressed.read_unsigned_byte();
+			SC_CHECK(compressed.read_unsigned_int() == sc::zstd::SEEKABLE_MAGIC);
+		}
+
+		const size_t ranges[][2] = {
+			{ 0, 100 },
+			{ frame_size - 10, 20 },
+			{ frame_size, frame_size },
+			{ 100000, 250000 },
+			{ data.size() - 1, 1 },
+			{ 490000, SIZE_MAX },
+			{ data.size(), 10 },
+			{ 1000, 0 },
+		};
+
+		for (const size_t* range : ranges)
+		{
+			compressed.seek(0);
+			BufferStream output;
+			sc::Decompressor::Zstd decompressor;
+			decompressor.decompress_range(compressed, output, range[0], range[1]);
+			SC_CHECK(range_equals(output, data, range[0], range[1]));
+		}
+
+		// Seek table frame is skipped by usual decompression
+		compressed.seek(0);
+		BufferStream decompressed;
+		sc::Decompressor::Zstd decompressor;
+		decompressor.decompress_stream(compressed, decompressed);
+		SC_CHECK(stream_equals(decompressed, data));
+	}
+}
+
+SC_TEST(zstd_forged_seek_table)
+{
+	std::vector<uint8_t> data = sc::test::make_data(300000);
+	const size_t frame_size = 64 * 1024;
+	size_t frames_count = (data.size() + frame_size - 1) / frame_size;
+
+	// Compressed length of one frame is changed, so frames no longer fill data before table
+	const int64_t changes[] = { 1000000, -1, 1 };
+	for (int64_t change : changes)
+	{
+		sc::Compressor::Zstd::Props props;
+		props.frame_size = frame_size;
+		props.write_seek_table = true;
+		props.workers_count = 0;
+		BufferStream compressed;
+		compress_zstd(data, compressed, props);
+
+		size_t entry_position = compressed.length() - sc::zstd::SEEK_TABLE_FOOTER_SIZE - (frames_count - 1) * sc::zstd::SEEK_TABLE_ENTRY_SIZE;
+		compressed.seek(entry_position);
+		uint32_t frame_length = compressed.read_unsigned_int();
+		compressed.seek(entry_position);
+		compressed.write_unsigned_int(static_cast<uint32_t>(frame_length + change));
+
+		// Table is ignored and range is found by streaming through frames
+		compressed.seek(0);
+		BufferStream output;
+		sc::Decompressor::Zstd decompressor;
+		decompressor.decompress_range(compressed, output, 250000, 10000);
+		SC_CHECK(range_equals(output, data, 250000, 10000));
+	}
+}
+
+SC_TEST(zstd_forged_content_size)
+{
+	std::vector<uint8_t> data = sc::test::make_data(300000);
+
+	sc::Compressor::Zstd::Props props;
+	props.workers_count = 0;
+	BufferStream compressed;
+	compress_zstd(data, compressed, props);
+
+	// Frame header: magic, descriptor, optional window descriptor and dictionary id, then content size
+	uint8_t* frame = (uint8_t*)compressed.data();
+	uint8_t descriptor = frame[4];
+	const size_t dictionary_id_sizes[] = { 0, 1, 2, 4 };
+	size_t content_size_offset = 5 + (descriptor & 0x20 ? 0 : 1) + dictionary_id_sizes[descriptor & 3];
+	SC_CHECK(descriptor >> 6 == 2);
+
+	// Content size that can not be produced from this data must not be allocated up front
+	memset(frame + content_size_offset, 0xF0, sizeof(uint32_t));
+
+	for (uint32_t threads_count : { 1u, 4u })
+	{
+		sc::Decompressor::Zstd::Props decompressor_props;
+		decompressor_props.threads_count = threads_count;
+
+		compressed.seek(0);
+		BufferStream decompressed;
+		sc::Decompressor::Zstd decompressor(decompressor_props);
+		SC_CHECK_THROWS(decompressor.decompress_stream(compressed, decompressed), sc::ZstdDecompressException);
+		SC_CHECK(data.size() * 2 > decompressed.length());
+	}
+}
+
+SC_TEST(zstd_high_ratio_round_trip)
+{
+	// Real data with ratio above presize limit is decompressed by growing output
+	std::vector<uint8_t> data(20 * 1024 * 1024, 0);
+	data[data.size() / 2] = 1;
+
+	sc::Compressor::Zstd::Props props;
+	props.workers_count = 0;
+	BufferStream compressed;
+	compress_zstd(data, compressed, props);
+	SC_CHECK(data.size() / sc::Decompressor::Zstd::Max_Reserve_Ratio > compressed.length());
+
+	BufferStream decompressed;
+	sc::Decompressor::Zstd decompressor;
+	decompressor.decompress_stream(compressed, decompressed);
+	SC_CHECK(stream_equals(decompressed, data));
+}
+
+SC_TEST(zstd_memory_matches_streaming)
+{
+	std::vector<uint8_t> data = sc::test::make_data(700000);
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "zstd_memory_matches_streaming.bin";
+	{
+		sc::OutputFileStream file(path);
+		file.write(data.data(), data.size());
+	}
+
+	sc::Compressor::Zstd::Props props;
+	props.workers_count = 0;
+
+	// Memory input into buffer is compressed by one call, file input is read in chunks
+	BufferStream one_shot;
+	compress_zstd(data, one_shot, props);
+
+	BufferStream streamed;
+	{
+		sc::InputFileStream input(path);
+		sc::Compressor::Zstd compressor(props);
+		compressor.compress_stream(input, streamed);
+	}
+	SC_CHECK(memory_equals(streamed.data(), streamed.length(), (const uint8_t*)one_shot.data(), one_shot.length()));
+
+	// Frame from one call has content size (size flag or single segment bit in frame header descriptor),
+	// so it is decompressed into presized output
+	uint8_t descriptor = ((const uint8_t*)one_shot.data())[4];
+	SC_CHECK((descriptor & 0xE0) != 0);
+	{
+		BufferStream decompressed;
+		sc::Decompressor::Zstd decompressor;
+		decompressor.decompress_stream(one_shot, decompressed);
+		SC_CHECK(decompressed.position() == data.size());
+		SC_CHECK(stream_equals(decompressed, data));
+	}
+
+	// Compressed data that is not in memory is still decompressed by streaming
+	{
+		std::filesystem::remove(path);
+		{
+			sc::OutputFileStream file(path);
+			file.write(one_shot.data(), one_shot.length());
+		}
+
+		sc::InputFileStream input(path);
+		BufferStream decompressed;
+		sc::Decompressor::Zstd decompressor;
+		decompressor.decompress_stream(input, decompressed);
+		SC_CHECK(stream_equals(decompressed, data));
+	}
+
+	std::filesystem::remove(path);
+}
+
+SC_TEST(zstd_dictionary_round_trip)
+{
+	std::vector<std::vector<uint8_t>> samples;
+	for (uint32_t i = 0; 200 > i; i++)
+	{
+		samples.push_back(sc::test::make_data(2000, i + 10));
+	}
+
+	std::vector<uint8_t> content = sc::zstd::train_dictionary(samples, 16 * 1024);
+	SC_CHECK(!content.empty());
+	sc::zstd::Dictionary dictionary(content.data(), content.size());
+
+	std::vector<uint8_t> data = sc::test::make_data(100000, 5);
+
+	sc::Compressor::Zstd::Props props;
+	props.frame_size = 16 * 1024;
+	props.workers_count = 0;
+	props.dictionary = &dictionary;
+	BufferStream compressed;
+	compress_zstd(data, compressed, props);
+
+	// Every frame references dictionary, so frames are decompressed with it in any thread
+	for (uint32_t threads_count : { 1u, 4u })
+	{
+		sc::Decompressor::Zstd::Props decompressor_props;
+		decompressor_props.threads_count = threads_count;
+		decompressor_props.dictionary = &dictionary;
+
+		compressed.seek(0);
+		BufferStream decompressed;
+		sc::Decompressor::Zstd decompressor(decompressor_props);
+		decompressor.decompress_stream(compressed, decompressed);
+		SC_CHECK(stream_equals(decompressed, data));
+	}
+
+	compressed.seek(0);
+	BufferStream decompressed;
+	sc::Decompressor::Zstd decompressor;
+	SC_CHECK_THROWS(decompressor.decompress_stream(compressed, decompressed), sc::ZstdDecompressException);
+}
+
+SC_TEST(zstd_dictionary_level)
+{
+	std::vector<std::vector<uint8_t>> samples;
+	for (uint32_t i = 0; 200 > i; i++)
+	{
+		samples.push_back(sc::test::make_data(2000, i + 10));
+	}
+
+	std::vector<uint8_t> content = sc::zstd::train_dictionary(samples, 16 * 1024);
+	std::vector<uint8_t> data = sc::test::make_data(200000, 5);
+
+	// Level of compressor is used both with dictionary prepared for the same level and for another level
+	for (int dictionary_level : { 3, 19 })
+	{
+		sc::zstd::Dictionary dictionary(content.data(), content.size(), dictionary_level);
+
+		size_t lengths[2];
+		const int levels[] = { 1, 19 };
+		for (size_t i = 0; 2 > i; i++)
+		{
+			sc::Compressor::Zstd::Props props;
+			props.compression_level = levels[i];
+			props.workers_count = 0;
+			props.dictionary = &dictionary;
+			BufferStream compressed;
+			compress_zstd(data, compressed, props);
+			lengths[i] = compressed.length();
+
+			sc::Decompressor::Zstd::Props decompressor_props;
+			decompressor_props.dictionary = &dictionary;
+			BufferStream decompressed;
+			sc::Decompressor::Zstd decompressor(decompressor_props);
+			decompressor.decompress_stream(compressed, decompressed);
+			SC_CHECK(stream_equals(decompressed, data));
+		}
+
+		SC_CHECK(lengths[0] > lengths[1]);
+	}
+}
+
+SC_TEST(zstd_delta_round_trip)
+{
+	std::vector<uint8_t> previous = sc::test::make_data(400000, 7);
+
+	// New version differs from previous one in a few places
+	std::vector<uint8_t> data = previous;
+	for (size_t i = 0; data.size() > i; i += 50000)
+	{
+		data[i] ^= 0x5A;
+	}
+	data.insert(data.begin() + 1000, 300, 0x42);
+
+	std::vector<uint8_t> unrelated = sc::test::make_data(previous.size(), 8);
+
+	for (size_t frame_size : { (size_t)0, (size_t)128 * 1024 })
+	{
+		sc::Compressor::Zstd::Props props;
+		props.frame_size = frame_size;
+		props.workers_count = 0;
+		BufferStream full;
+		compress_zstd(data, full, props);
+
+		props.reference = previous.data();
+		props.reference_length = previous.size();
+		BufferStream patch;
+		compress_zstd(data, patch, props);
+
+		// Data that is present in reference is not stored again
+		SC_CHECK(full.length() / 10 > patch.length());
+
+		for (uint32_t threads_count : { 1u, 4u })
+		{
+			sc::Decompressor::Zstd::Props decompressor_props;
+			decompressor_props.threads_count = threads_count;
+			decompressor_props.reference = previous.data();
+			decompressor_props.reference_length = previous.size();
+
+			patch.seek(0);
+			BufferStream decompressed;
+			sc::Decompressor::Zstd decompressor(decompressor_props);
+			decompressor.decompress_stream(patch, decompressed);
+			SC_CHECK(stream_equals(decompressed, data));
+		}
+
+		// Patch applied to another reference gives wrong data or fails, but never original data
+		sc::Decompressor::Zstd::Props decompressor_props;
+		decompressor_props.reference = unrelated.data();
+		decompressor_props.reference_length = unrelated.size();
+
+		patch.seek(0);
+		BufferStream decompressed;
+		sc::Decompressor::Zstd decompressor(decompressor_props);
+		try
+		{
+			decompressor.decompress_stream(patch, decompressed);
+		}
+		catch (const sc::ZstdDecompressException&)
+		{
+		}
+		SC_CHECK(!stream_equals(decompressed, data));
+	}
+}
+
+SC_TEST(zstd_delta_far_match)
+{
+	const size_t length = 1 << 20;
+	std::vector<uint8_t> previous = sc::test::make_data(length, 9);
+
+	// Start of reference is moved to second half of new version, further than reference length from its copy
+	std::vector<uint8_t> data = sc::test::make_data(length / 2, 10);
+	data.insert(data.end(), previous.begin(), previous.begin() + length / 2);
+
+	sc::Compressor::Zstd::Props props;
+	props.workers_count = 0;
+	props.reference = previous.data();
+	props.reference_length = previous.size();
+	BufferStream patch;
+	compress_zstd(data, patch, props);
+
+	// Only new half is stored
+	SC_CHECK(length * 3 / 4 > patch.length());
+
+	sc::Decompressor::Zstd::Props decompressor_props;
+	decompressor_props.reference = previous.data();
+	decompressor_props.reference_length = previous.size();
+
+	patch.seek(0);
+	BufferStream decompressed;
+	sc::Decompressor::Zstd decompressor(decompressor_props);
+	decompressor.decompress_stream(patch, decompressed);
+	SC_CHECK(stream_equals(decompressed, data));
+}
+
+// Passes everything compressor wrote since previous call to live decompressor
+static bool pass_live_data(BufferStream& wire, size_t& wire_position, sc::Decompressor::Zstd& decompressor, Stream& output)
+{
+	size_t length = wire.length() - wire_position;
+	bool frame_finished = decompressor.decompress_chunk(output, (const uint8_t*)wire.data() + wire_position, length);
+	wire_position = wire.length();
+
+	return frame_finished;
+}
+
+SC_TEST(zstd_live_streaming)
+{
+	std::vector<uint8_t> data = sc::test::make_data(100000, 3);
+	const size_t chunk_size = 700;
+
+	sc::Compressor::Zstd::Props props;
+	props.workers_count = 0;
+	props.flush_size = 2000;
+	sc::Compressor::Zstd compressor(props);
+
+	sc::Decompressor::Zstd decompressor;
+	BufferStream wire;
+	size_t wire_position = 0;
+	BufferStream decompressed;
+
+	// Consumer receives all data as soon as size threshold is reached
+	size_t unflushed_length = 0;
+	for (size_t offset = 0; data.size() > offset; offset += chunk_size)
+	{
+		size_t length = std::min(chunk_size, data.size() - offset);
+		compressor.compress_chunk(wire, data.data() + offset, length);
+		pass_live_data(wire, wire_position, decompressor, decompressed);
+
+		unflushed_length += length;
+		if (unflushed_length >= props.flush_size)
+		{
+			unflushed_length = 0;
+			SC_CHECK(decompressed.length() == offset + length);
+		}
+	}
+
+	compressor.end(wire);
+	SC_CHECK(pass_live_data(wire, wire_position, decompressor, decompressed));
+	SC_CHECK(stream_equals(decompressed, data));
+}
+
+SC_TEST(zstd_live_flush_interval)
+{
+	std::vector<uint8_t> data = sc::test::make_data(1000, 4);
+
+	// Time threshold is counted from frame start, so first chunk of frame is not flushed right away
+	sc::Compressor::Zstd::Props props;
+	props.workers_count = 0;
+	props.flush_interval = 60 * 60 * 1000;
+	sc::Compressor::Zstd compressor(props);
+
+	sc::Decompressor::Zstd decompressor;
+	BufferStream wire;
+	size_t wire_position = 0;
+	BufferStream decompressed;
+
+	compressor.compress_chunk(wire, data.data(), data.size());
+	pass_live_data(wire, wire_position, decompressor, decompressed);
+	SC_CHECK(data.size() > decompressed.length());
+
+	// Caller flushes during stalls itself
+	compressor.flush(wire);
+	pass_live_data(wire, wire_position, decompressor, decompressed);
+	SC_CHECK(stream_equals(decompressed, data));
+
+	compressor.end(wire);
+	SC_CHECK(pass_live_data(wire, wire_position, decompressor, decompressed));
+}
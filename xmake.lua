@@ -31,3 +31,15 @@ target("supercell_compression_cli")
     add_files("cli/**.cpp")
     
     add_deps("supercell_compression")
+
+target("supercell_compression_tests")
+    set_default(false)
+    set_kind("binary")
+
+    add_packages("supercell_core")
+
+    add_headerfiles("tests/**.h")
+    add_files("tests/**.cpp")
+    add_tests("default")
+
+    add_deps("supercell_compression")